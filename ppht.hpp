@@ -93,6 +93,7 @@
 #define ppht_hpp
 
 #include "ppht/accumulator.hpp"
+#include "ppht/observer.hpp"
 #include "ppht/parameters.hpp"
 #include "ppht/point_set.hpp"
 #include "ppht/postprocess.hpp"
@@ -106,6 +107,412 @@
  */
 namespace ppht {
 
+/**
+ * @brief The vote and time budgets of a search.
+ *
+ * @sa parameters::max_votes, parameters::time_budget
+ */
+class vote_budget {
+    /// The clock measuring the time budget.
+    using clock = std::chrono::steady_clock;
+
+    /// The number of votes between readings of the clock.
+    static constexpr std::size_t clock_interval = 8;
+
+    /// The end of the time budget.
+    clock::time_point _deadline;
+
+    /// The vote budget; zero for none.
+    std::size_t _max_votes;
+
+    /// Whether there is a time budget.
+    bool _timed;
+
+    /// The number of votes taken.
+    std::size_t _votes = 0;
+
+  public:
+    /**
+     * @brief Start the budgets of a search.
+     *
+     * @param param the parameters holding the budgets
+     */
+    explicit vote_budget(parameters const &param)
+        : _deadline(clock::now() + param.time_budget)
+        , _max_votes(param.max_votes)
+        , _timed(param.time_budget.count() > 0) {}
+
+    /**
+     * @brief Take one vote from the budget.
+     *
+     * Call this once a pixel has been drawn, so that a budget just
+     * large enough for every pending pixel is not reported as spent.
+     *
+     * @return false if the budget is spent
+     */
+    bool take() {
+        if (_max_votes && _votes == _max_votes) return false;
+
+        if (_timed && _votes % clock_interval == 0 &&
+            clock::now() >= _deadline) {
+            return false;
+        }
+
+        ++_votes;
+        return true;
+    }
+};
+
+/**
+ * @brief Vote a pixel drawn from a state.
+ *
+ * The drivers vote and unvote through this function and @ref
+ * unvote_pixel() so that a state may carry more than the status of
+ * each pixel; see @ref oriented_state.  This version votes in every
+ * column.
+ *
+ * @param state the state the pixel was drawn from
+ *
+ * @param accumulator the accumulator
+ *
+ * @param p the pixel
+ *
+ * @param segment set to the line found, if any
+ *
+ * @param observer the observer
+ *
+ * @return the result of the vote
+ */
+template <class State, class Accumulator, class Observer>
+static inline bool vote_pixel(State &state, Accumulator &accumulator,
+                              point_t const &p, segment_t &segment,
+                              Observer &observer) {
+    (void)state;
+    return observed_vote(accumulator, p, segment, observer);
+}
+
+/**
+ * @brief Withdraw the vote of a pixel made by @ref vote_pixel().
+ *
+ * @param state the state the pixel was drawn from
+ *
+ * @param accumulator the accumulator
+ *
+ * @param p the pixel
+ */
+template <class State, class Accumulator>
+static inline void unvote_pixel(State &state, Accumulator &accumulator,
+                                point_t const &p) {
+    (void)state;
+    accumulator.unvote(p);
+}
+
+/**
+ * @brief Return a pixel drawn from a state to the pending set.
+ *
+ * The drivers call this when a pixel has been drawn but the budget
+ * does not allow its vote, so that the search can be resumed.
+ *
+ * @param state the state the pixel was drawn from
+ *
+ * @param p the pixel
+ */
+template <class State>
+static inline void restore_pixel(State &state, point_t const &p) {
+    state.mark_pending(p);
+}
+
+/**
+ * @brief Remove the pixels of an accepted segment.
+ *
+ * Marks every pixel of @c found as @c done, withdrawing the votes of
+ * those that had been voted.
+ *
+ * @param state the state holding the pixels
+ *
+ * @param accumulator the accumulator holding the votes
+ *
+ * @param found the pixels of the segment
+ *
+ * @param observer told of the unvotes and of the pixels consumed
+ *
+ * @throws std::logic_error if a pixel of the segment is neither @c
+ *   pending nor @c voted
+ */
+template <class State, class Accumulator, class Observer>
+void consume_segment(State &state, Accumulator &accumulator,
+                     point_set const &found, Observer &observer) {
+    std::size_t consumed = 0;
+
+    for (auto &&point : found) {
+        auto status = state.status(point);
+
+        if (status == status_t::voted) {
+            unvote_pixel(state, accumulator, point);
+            observer.unvoted();
+        }
+        else {
+            if (status != status_t::pending) {
+                using namespace std;
+                throw std::logic_error{"Unexpected pixel with status "s +
+                                       to_string(status)};
+            }
+        }
+
+        state.mark_done(point);
+        ++consumed;
+    }
+
+    observer.consumed(consumed);
+}
+
+/**
+ * @brief Run the PPHT algorithm, passing each segment to a function as
+ * soon as it is found.
+ *
+ * This is the loop at the heart of @ref find_segments(): it iterates
+ * over the set points in the @c state matrix, voting them into @c
+ * accumulator, and calls @c emit with every segment accepted by the
+ * channel scan.  The segments are not post-processed, so a line
+ * broken by a gap may be reported in several pieces; see @ref
+ * postprocess().
+ *
+ * If @c emit returns false, or when the budget set by @ref
+ * parameters::max_votes or @ref parameters::time_budget is spent, the
+ * function stops at once, leaving the remaining pixels pending.  Any
+ * stop condition (a number of segments, a deadline, a segment of a
+ * certain length) can be expressed this way:
+ *
+ * @code
+ * auto const enough = param.min_length * 4;
+ *
+ * ppht::for_each_segment(state, accumulator, param, buffer,
+ *                        [&](ppht::segment_t const &s) {
+ *     steer(s);
+ *     return (s.second - s.first).length_squared() < enough * enough;
+ * });
+ * @endcode
+ *
+ * On return the accumulator still holds the votes of the pixels left
+ * with status @c voted, so the search may be resumed by calling the
+ * function again.
+ *
+ * @tparam State the class of the state parameter
+ *
+ * @tparam Accumulator the class of the accumulator
+ *
+ * @tparam Callback the type of the function
+ *
+ * @param state an initialized @ref ppht::state object or something
+ * similar
+ *
+ * @param accumulator an accumulator of the same dimensions as @c
+ * state, holding no votes other than those of pixels with status @c
+ * voted
+ *
+ * @param param tuning parameters; @ref parameters::max_theta and the
+ * threshold values are taken from the accumulator
+ *
+ * @param buffer scratch storage for @ref scan()
+ *
+ * @param emit a function taking a <code>segment_t const &</code> and
+ * returning true to continue or false to stop
+ *
+ * @param observer told of the votes, scans and phases; see @ref
+ * null_observer
+ *
+ * @return false if @c emit or the budget stopped the search, true if
+ * every pixel was processed
+ */
+template <class State, class Accumulator, class Callback, class Observer>
+bool for_each_segment(State &state, Accumulator &accumulator,
+                      const parameters &param, scan_buffer &buffer,
+                      Callback &&emit, Observer &observer) {
+    const auto min_length_squared = param.min_length * param.min_length;
+
+    point_t point;
+
+    const auto channel_radius = param.channel_width >> 1;
+
+    vote_budget budget{param};
+
+    for (;;) {
+        if (!state.next(point)) break;
+
+        if (!budget.take()) {
+            restore_pixel(state, point);
+            return false;
+        }
+
+        segment_t scan_channel;
+
+        observer.begin_phase(phase_t::voting);
+        observer.voted();
+
+        auto const triggered =
+            vote_pixel(state, accumulator, point, scan_channel, observer);
+
+        observer.end_phase(phase_t::voting);
+
+        if (triggered) {
+            observer.begin_phase(phase_t::scanning);
+
+            auto const &found = scan(state, scan_channel, channel_radius,
+                                     param.max_gap, buffer);
+
+            auto const accepted =
+                found.length_squared() >= min_length_squared;
+
+            observer.scanned(accepted);
+
+            if (accepted) consume_segment(state, accumulator, found, observer);
+
+            observer.end_phase(phase_t::scanning);
+
+            if (accepted && !emit(found.segment())) return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Run the PPHT algorithm, passing each segment to a function as
+ * soon as it is found.
+ *
+ * Equivalent to the overload taking an observer, with a @ref
+ * null_observer.
+ *
+ * @tparam State the class of the state parameter
+ *
+ * @tparam Accumulator the class of the accumulator
+ *
+ * @tparam Callback the type of the function
+ *
+ * @param state an initialized @ref ppht::state object or something
+ * similar
+ *
+ * @param accumulator an accumulator of the same dimensions as @c
+ * state, holding no votes other than those of pixels with status @c
+ * voted
+ *
+ * @param param tuning parameters
+ *
+ * @param buffer scratch storage for @ref scan()
+ *
+ * @param emit a function taking a <code>segment_t const &</code> and
+ * returning true to continue or false to stop
+ *
+ * @return false if @c emit or the budget stopped the search, true if
+ * every pixel was processed
+ */
+template <class State, class Accumulator, class Callback>
+bool for_each_segment(State &state, Accumulator &accumulator,
+                      const parameters &param, scan_buffer &buffer,
+                      Callback &&emit) {
+    null_observer observer;
+    return for_each_segment(state, accumulator, param, buffer,
+                            std::forward<Callback>(emit), observer);
+}
+
+/**
+ * @brief Run the PPHT algorithm with caller-supplied resources.
+ *
+ * Collects the segments found by @ref for_each_segment(), appending
+ * them to @c segments.  Only the appended segments are
+ * post-processed.  If the budget set in @c param is spent, the
+ * segments found so far are post-processed and kept.
+ *
+ * The caller keeps ownership of the accumulator, the scratch storage
+ * of the channel scans and the output vector, so they can be reused
+ * from one image to the next; see @ref detector.  On return, the
+ * accumulator still holds the votes of the pixels left with status @c
+ * voted.
+ *
+ * @tparam State the class of the state parameter
+ *
+ * @tparam Accumulator the class of the accumulator
+ *
+ * @tparam Allocator the allocator of the output vector, also used for
+ * the scratch storage of @ref postprocess(); with an @ref
+ * arena_allocator, a frame run with reused resources does not touch
+ * the heap
+ *
+ * @param state an initialized @ref ppht::state object or something
+ * similar
+ *
+ * @param accumulator an accumulator of the same dimensions as @c
+ * state, holding no votes other than those of pixels with status @c
+ * voted
+ *
+ * @param param tuning parameters; @ref parameters::max_theta and the
+ * threshold values are taken from the accumulator
+ *
+ * @param segments the vector to which the segments are appended
+ *
+ * @param buffer scratch storage for @ref scan()
+ *
+ * @param observer told of the events of the run; see @ref
+ * null_observer
+ */
+template <class State, class Accumulator, class Allocator, class Observer>
+void find_segments(State &state, Accumulator &accumulator,
+                   const parameters &param,
+                   std::vector<segment_t, Allocator> &segments,
+                   scan_buffer &buffer, Observer &observer) {
+    const auto first = segments.size();
+
+    for_each_segment(state, accumulator, param, buffer,
+                     [&](segment_t const &segment) {
+                         segments.push_back(segment);
+                         return true;
+                     },
+                     observer);
+
+    observer.begin_phase(phase_t::postprocessing);
+
+    segments.erase(postprocess(segments.begin() + first, segments.end(),
+                               param.channel_width >> 1, observer,
+                               segments.get_allocator()),
+                   segments.end());
+
+    observer.end_phase(phase_t::postprocessing);
+}
+
+/**
+ * @brief Run the PPHT algorithm with caller-supplied resources.
+ *
+ * Equivalent to the overload taking an observer, with a @ref
+ * null_observer.
+ *
+ * @tparam State the class of the state parameter
+ *
+ * @tparam Accumulator the class of the accumulator
+ *
+ * @tparam Allocator the allocator of the output vector
+ *
+ * @param state an initialized @ref ppht::state object or something
+ * similar
+ *
+ * @param accumulator an accumulator of the same dimensions as @c
+ * state, holding no votes other than those of pixels with status @c
+ * voted
+ *
+ * @param param tuning parameters
+ *
+ * @param segments the vector to which the segments are appended
+ *
+ * @param buffer scratch storage for @ref scan()
+ */
+template <class State, class Accumulator, class Allocator>
+void find_segments(State &state, Accumulator &accumulator,
+                   const parameters &param,
+                   std::vector<segment_t, Allocator> &segments,
+                   scan_buffer &buffer) {
+    null_observer observer;
+    find_segments(state, accumulator, param, segments, buffer, observer);
+}
+
 /**
  * @brief Simplified interface to the PPHT algorithm.
  *
@@ -133,6 +540,10 @@ namespace ppht {
  *
  * @tparam Accumulator the class to use for the accumulator
  *
+ * @tparam Param the class of the parameters: @ref parameters, or
+ * @ref static_parameters to give the accumulator a shared
+ * trigonometry table
+ *
  * @param state an initialized @ref ppht::state object or something
  * similar
  *
@@ -143,55 +554,58 @@ namespace ppht {
  *
  * @returns a vector of line segments
  */
-template <class State, class Accumulator = accumulator<>>
+template <class State, class Accumulator = accumulator<>,
+          class Param = parameters>
 std::vector<segment_t>
-find_segments(State &&state, const parameters &param = parameters{},
+find_segments(State &&state, Param const &param = Param{},
               std::random_device::result_type seed = std::random_device{}()) {
-    const auto min_length_squared = param.min_length * param.min_length;
-
     std::vector<segment_t> segments;
 
     Accumulator accumulator{state.rows(), state.cols(), param, seed};
+    scan_buffer buffer;
 
-    point_t point;
-
-    const auto channel_radius = param.channel_width >> 1;
+    find_segments(state, accumulator, param, segments, buffer);
 
-    while (state.next(point)) {
-        segment_t scan_channel;
-
-        if (accumulator.vote(point, scan_channel)) {
-            point_set found = scan(state, scan_channel, channel_radius,
-                                   param.max_gap);
-
-            if (found.length_squared() >= min_length_squared) {
-                for (auto &&point : found) {
-                    auto status = state.status(point);
-
-                    if (status == status_t::voted) {
-                        accumulator.unvote(point);
-                    }
-                    else {
-                        if (status != status_t::pending) {
-                            using namespace std;
-                            throw std::logic_error{
-                                "Unexpected pixel with status "s +
-                                to_string(status)};
-                        }
-                    }
-
-                    state.mark_done(point);
-                }
-
-                segments.push_back(found.segment());
-            }
-        }
-    }
+    return segments;
+}
 
-    segments.erase(postprocess(segments.begin(), segments.end(),
-                               channel_radius), segments.end());
+/**
+ * @brief Simplified interface to @ref for_each_segment().
+ *
+ * @tparam State the class of the state parameter
+ *
+ * @tparam Callback the type of the function
+ *
+ * @tparam Accumulator the class to use for the accumulator
+ *
+ * @tparam Param the class of the parameters, as for @ref
+ * find_segments()
+ *
+ * @param state an initialized @ref ppht::state object or something
+ * similar
+ *
+ * @param emit a function taking a <code>segment_t const &</code> and
+ * returning true to continue or false to stop
+ *
+ * @param param optional tuning parameters to adjust the behavior of
+ * the algorithm
+ *
+ * @param seed a value to use as a seed for the URBG
+ *
+ * @return false if @c emit or the budget stopped the search, true if
+ * every pixel was processed
+ */
+template <class State, class Callback, class Accumulator = accumulator<>,
+          class Param = parameters>
+bool for_each_segment(State &&state, Callback &&emit,
+                      Param const &param = Param{},
+                      std::random_device::result_type seed =
+                          std::random_device{}()) {
+    Accumulator accumulator{state.rows(), state.cols(), param, seed};
+    scan_buffer buffer;
 
-    return segments;
+    return for_each_segment(state, accumulator, param, buffer,
+                            std::forward<Callback>(emit));
 }
 
 } // namespace ppht
@@ -1,6 +1,8 @@
 #ifndef ppht_accumulator_hpp
 #define ppht_accumulator_hpp
 
+#include <ppht/kernel.hpp>
+#include <ppht/observer.hpp>
 #include <ppht/parameters.hpp>
 #include <ppht/raster.hpp>
 #include <ppht/trig.hpp>
@@ -15,7 +17,6 @@
 #include <limits>
 #include <memory>
 #include <random>
-#include <set>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -35,10 +36,15 @@ namespace ppht {
  *
  * @tparam Count the type used for the counters
  *
- * @tparam Raster the type used for the matrix of counters
+ * @tparam Raster the type used for the matrix of counters; see @ref
+ *   tiled_raster and @ref spill_raster
+ *
+ * @tparam Kernel the class used to compute rho values while voting;
+ *   see @ref scalar_kernel and @ref simd_kernel
  */
 template <class Count = std::uint16_t,
-          template <class> class Raster = raster>
+          template <class> class Raster = raster,
+          class Kernel = scalar_kernel>
 class accumulator {
     /// A uniform random bit generator.
     using URBG = std::default_random_engine;
@@ -67,38 +73,82 @@ class accumulator {
     /// Matrix of counters (quantized @f$\theta\rho@f$-space).
     Raster<Count> _counters;
 
-    /// Votes still in effect.
-    Count _votes = 0;
+    /// The kernel computing rho values for a block of thetas.
+    Kernel const _kernel;
+
+    /// The number of thetas handed to the kernel at a time.
+    static constexpr std::size_t block_size = 64;
+
+    /// How many times a scattered write costs a sequential one when
+    /// choosing how to reset the counters.
+    static constexpr std::size_t scatter_cost = 8;
+
+    /// A vote in effect, for @ref reset().
+    struct dirty_t {
+        /// The point voted.
+        point_t point;
+
+        /// The first column voted.
+        std::size_t first;
+
+        /// The number of columns voted, taken modulo max_theta.
+        std::size_t count;
+    };
+
+    /// The votes in effect, while clearing their sinusoids costs less
+    /// than clearing the whole matrix.
+    std::vector<dirty_t> _voted;
+
+    /// The number of cells on the sinusoids of @ref _voted.
+    std::size_t _dirty_cells = 0;
+
+    /// Set once the votes in effect have covered too many cells for
+    /// @ref _voted to be of use; @ref reset() then clears the whole
+    /// matrix and @ref _voted stops changing.
+    bool _saturated = false;
+
+    /// The row of each column incremented by the last vote.
+    std::vector<long> _rows_voted;
+
+    /// Scratch storage for the candidates of a vote, as theta and
+    /// unscaled rho; never grows past its initial capacity of
+    /// max_theta.
+    std::vector<std::pair<std::size_t, double>> _found;
+
+    /// The range of vote counts for which a count of @c n is not
+    /// significant; see @ref significant().
+    struct vote_bounds {
+        /// The smallest number of votes accepting the null hypothesis.
+        std::size_t lo;
+
+        /// The largest number of votes accepting the null hypothesis.
+        std::size_t hi;
+
+        /// Set once @c lo and @c hi have been computed.
+        bool ready = false;
+    };
+
+    /// The vote bounds, indexed by count up to the largest count a
+    /// cell can reach; filled in on demand.
+    std::vector<vote_bounds> _bounds;
+
+    /// The number of oriented votes in effect in each column; empty
+    /// until the first oriented vote.
+    std::vector<std::size_t> _coverage;
 
     /// Random number generator.
     URBG _urbg;
 
-    /**
-     * @brief Convert a raw rho value to an index value.
-     *
-     * Scale rho according to @ref _rho_scale, then add half the
-     * height of the counter matrix to it.
-     *
-     * @param unscaled_rho the raw rho value
-     *
-     * @return a rho value that is scaled and translated
-     *
-     * @sa unscale_rho()
-     */
-    double scale_rho(double unscaled_rho) const noexcept {
-        double const offset = _counters.rows() >> 1;
-        return std::rint(std::scalbn(unscaled_rho, _rho_scale) + offset);
-    }
-
     /**
      * @brief Convert a scaled rho value back to a raw value.
      *
-     * Perform the transform of @ref scale_rho() in reverse.
+     * Perform the transform of the voting kernel in reverse.
      *
      * @param scaled_rho the scaled rho value
      *
      * @return a rho value that is no longer scaled or translated
      *
+     * @sa scalar_kernel
      */
     double unscale_rho(double scaled_rho) const noexcept {
         double const offset = _counters.rows() >> 1;
@@ -146,7 +196,8 @@ class accumulator {
      *
      * @param cols the width of the image
      *
-     * @param max_theta the number of parts per semiturn
+     * @param trig the trigonometry table, giving the number of parts
+     *   per semiturn
      *
      * @param rho_info the maximum value a scaled rho can take and the
      *   scale factor
@@ -159,18 +210,35 @@ class accumulator {
      *
      * @param seed the seed for the URBG
      */
-    accumulator(std::size_t rows, std::size_t cols, std::size_t max_theta,
+    accumulator(std::size_t rows, std::size_t cols, trig_table &&trig,
                 const std::pair<std::size_t, int> &rho_info,
                 double log_threshold, std::size_t min_trigger_points,
                 seed_t seed) noexcept
-        : _trig(max_theta)
+        : _trig(std::move(trig))
         , _rows(rows)
         , _cols(cols)
         , _rho_scale(rho_info.second)
         , _log_threshold(log_threshold)
         , _min_trigger_points(min_trigger_points)
-        , _counters(rho_info.first, max_theta)
-        , _urbg(seed) {}
+        , _counters(rho_info.first, _trig.max_theta)
+        , _kernel(_trig, rho_info.second, rho_info.first)
+        , _rows_voted(_trig.max_theta)
+        , _urbg(seed) {
+        _found.reserve(_trig.max_theta);
+        _voted.reserve(rho_info.first / scatter_cost + 1);
+
+        // The pixels counted in a cell lie in a strip 2^-e pixels
+        // wide across the image; the margin covers the pixels the
+        // strip clips at its edges and ends.
+
+        auto const strip = std::ceil(std::scalbn(1.0, -rho_info.second)) + 2;
+        auto const length = std::ceil(std::hypot(rows, cols)) + 1;
+
+        auto const largest = std::min<double>(
+            std::numeric_limits<Count>::max(), strip * length);
+
+        _bounds.resize(static_cast<std::size_t>(largest) + 1);
+    }
 
   public:
     /**
@@ -235,11 +303,39 @@ class accumulator {
      */
     accumulator(std::size_t rows, std::size_t cols, parameters const &param,
                 seed_t seed = std::random_device{}())
-        : accumulator(rows, cols, param.max_theta,
+        : accumulator(rows, cols, trig_table{param.max_theta},
                       rho_info(rows, cols, param.max_theta),
                       std::log(param.threshold), param.min_trigger_points,
                       seed) {}
 
+    /**
+     * @brief Construct an instance of @ref accumulator with a
+     * compile-time resolution.
+     *
+     * The trigonometry table is that of @ref static_trig_table(),
+     * shared with every other accumulator of the same resolution, so
+     * construction does not compute it.  The accumulator is otherwise
+     * the same as one constructed from the equivalent @ref parameters.
+     *
+     * @param rows the height of the bitmap
+     *
+     * @param cols the width of the bitmap
+     *
+     * @param param parameters controlling the operation of the accumulator
+     *
+     * @param seed the seed for the random number generator used to
+     *        break ties.
+     */
+    template <std::uint16_t MaxTheta, std::uint16_t ChannelWidth>
+    accumulator(std::size_t rows, std::size_t cols,
+                static_parameters<MaxTheta, ChannelWidth> const &param,
+                seed_t seed = std::random_device{}())
+        : accumulator(rows, cols,
+                      trig_table::view_of(static_trig_table<MaxTheta>()),
+                      rho_info(rows, cols, MaxTheta),
+                      std::log(param.values().threshold),
+                      param.values().min_trigger_points, seed) {}
+
     /**
      * @brief Find the portion of the line that lies within the bounds
      * of the bitmap.
@@ -257,13 +353,28 @@ class accumulator {
     segment_t find_segment(std::size_t theta, double rho) {
         // There are a few degenerate cases where multiple matches for
         // the same endpoint can be found, e.g., a line through the
-        // origin.  Using a set eliminates most of these cases.  See
-        // the comment at the end for what happens to those that slip
+        // origin.  Keeping only the least and greatest of the matches
+        // eliminates most of these cases without allocating.  See the
+        // comment at the end for what happens to those that slip
         // through.
 
-        std::set<point_t> endpoints;
+        point_t first, last;
+        bool found = false;
+
+        auto add = [&](long x, long y) {
+            point_t const p{x, y};
+
+            if (!found) {
+                first = last = p;
+                found = true;
+            }
+            else {
+                first = std::min(first, p);
+                last = std::max(last, p);
+            }
+        };
 
-        auto const &cossin = _trig[theta];
+        auto const cossin = _trig[theta];
         auto const &sin_theta = std::get<1>(cossin);
         auto const &cos_theta = std::get<0>(cossin);
 
@@ -283,118 +394,559 @@ class accumulator {
         auto y_max = get_y(_cols - 1);
 
         if (0 <= y_min && y_min < static_cast<int>(_rows)) {
-            endpoints.emplace(0, y_min);
+            add(0, y_min);
         }
         if (0 <= x_min && x_min < static_cast<int>(_cols)) {
-            endpoints.emplace(x_min, 0);
+            add(x_min, 0);
         }
         if (0 <= y_max && y_max < static_cast<int>(_rows)) {
-            endpoints.emplace(_cols - 1, y_max);
+            add(_cols - 1, y_max);
         }
         if (0 <= x_max && x_max < static_cast<int>(_cols)) {
-            endpoints.emplace(x_max, _rows - 1);
+            add(x_max, _rows - 1);
         }
 
-        if (endpoints.empty()) {
+        if (!found) {
             throw std::logic_error{"line (" + std::to_string(theta) + ", " +
                                    std::to_string(rho) +
                                    ") does not intersect bitmap"};
         }
 
-        // If endpoints.size() > 2, ignore the points in the middle.
-        // If endpoints.size() == 1, create single-pixel segment.
+        // If more than two distinct points match, ignore the points in
+        // the middle.  If only one does, create a single-pixel segment.
 
-        return segment_t{*endpoints.begin(), *endpoints.rbegin()};
+        return segment_t{first, last};
     }
 
+  protected:
+    /// Votes still in effect.
+    std::size_t _votes = 0;
+
     /**
-     * @brief Add all lines passing through the given point to the
-     * accumulator.
+     * @brief Get the trigonometry table.
      *
-     * Returns true if the likelihood of the largest count in the
-     * register exceeds the threshold.
+     * @return the table indexed by column
+     */
+    trig_table const &trig() const noexcept {
+        return _trig;
+    }
+
+    /**
+     * @brief Compute the log-probability of a count.
      *
-     * @param p the point to register
+     * Assuming the null hypothesis (the image is random noise),
+     * E[n] = votes/max_rho for all cells in the register, and the
+     * cells are filled (roughly) according to a Poisson model:
      *
-     * @param segment set to the intersection of the line found and
-     *   the bounds of the image only if the function returns true
+     *    p(n) = λⁿ/n!·exp(-λ)
+     *         = λⁿ/Γ(n+1)·exp(-λ)
+     * ln p(n) = n·ln(λ) - lnΓ(n+1) - λ
      *
-     * @return true if the number of votes for the line segment pass
-     *   the threshold
+     * @param n the count of a cell
      *
-     * @see unvote()
+     * @param votes the number of votes in effect
+     *
+     * @return the natural logarithm of p(n)
      */
-    bool vote(point_t const &p, segment_t &segment) {
-        auto const max_rho = _counters.rows();
+    double log_probability(Count n, std::size_t votes) const noexcept {
+        double const lambda = static_cast<double>(votes) / _counters.rows();
+        return n * std::log(lambda) - std::lgamma(n + 1) - lambda;
+    }
+
+    /**
+     * @brief Test whether a count rejects the null hypothesis.
+     *
+     * Equivalent to comparing @ref log_probability() against the
+     * threshold, but without calling the math library on each vote.
+     * For a fixed @f$n > 0@f$, @f$n\ln\lambda - \lambda@f$ is concave
+     * in @f$\lambda@f$ with its maximum at @f$\lambda = n@f$, so the
+     * vote counts that accept the null hypothesis form an interval.
+     * Its endpoints are found once per @f$n@f$, by bisection on the
+     * same expression, and cached; the test is then two integer
+     * comparisons.  The cache is sized by the constructor, so voting
+     * never allocates.
+     *
+     * @param n the largest count produced by @ref tally()
+     *
+     * @param votes the number of votes in effect in the column of the
+     *   count
+     *
+     * @return true if the null hypothesis is rejected
+     */
+    bool significant(Count n, std::size_t votes) {
+        // Zero is not concave in the sense above; n never is zero
+        // unless min_trigger_points is.  No cell can reach a count
+        // past the cache, but the direct test stands in if one does.
+
+        if (n == 0 || n >= _bounds.size()) {
+            return !(log_probability(n, votes) >= _log_threshold);
+        }
+
+        auto &bounds = _bounds[n];
+
+        if (!bounds.ready) {
+            auto const accepts = [&](std::size_t votes) {
+                return log_probability(n, votes) >= _log_threshold;
+            };
+
+            std::size_t const peak = n * _counters.rows();
+
+            if (!accepts(peak)) {
+                bounds.lo = 1;
+                bounds.hi = 0;
+            }
+            else {
+                // accepts() is false at zero votes and rises to true
+                // at the peak...
+
+                std::size_t lo = 0, hi = peak;
+
+                while (hi - lo > 1) {
+                    auto const mid = lo + (hi - lo) / 2;
+                    (accepts(mid) ? hi : lo) = mid;
+                }
+
+                bounds.lo = hi;
+
+                // ...then falls back to false somewhere past it.
+
+                lo = peak, hi = 2 * peak;
+
+                while (accepts(hi)) lo = hi, hi *= 2;
+
+                while (hi - lo > 1) {
+                    auto const mid = lo + (hi - lo) / 2;
+                    (accepts(mid) ? lo : hi) = mid;
+                }
+
+                bounds.hi = lo;
+            }
+
+            bounds.ready = true;
+        }
+
+        return votes < bounds.lo || bounds.hi < votes;
+    }
+
+    /**
+     * @brief Get the voting kernel.
+     *
+     * @return the kernel computing the scaled rho values
+     */
+    Kernel const &kernel() const noexcept {
+        return _kernel;
+    }
+
+    /**
+     * @brief Get the matrix of counters.
+     *
+     * For implementations that update the counters other than
+     * through @ref tally() and @ref untally().
+     *
+     * @return the counters, indexed by scaled rho and theta
+     */
+    Raster<Count> &counters() noexcept {
+        return _counters;
+    }
+
+    /**
+     * @brief Compute the row of every column for a point, without
+     * changing the counters.
+     *
+     * Stands in for the bookkeeping of @ref tally() when the counters
+     * were updated elsewhere, so that @ref conclude() can find the
+     * candidates of the point.
+     *
+     * @param p the point
+     */
+    void locate(point_t const &p) {
         auto const max_theta = _counters.cols();
 
-        Count n = _min_trigger_points;
+        for (std::size_t first = 0; first < max_theta; first += block_size) {
+            auto const stop = std::min(first + block_size, max_theta);
+            _kernel(_trig, p, first, stop, _rows_voted.data() + first);
+        }
+    }
 
-        using line_t = std::pair<std::size_t, double>;
+    /**
+     * @brief Record a vote whose columns have all been tallied.
+     *
+     * @param p the point voted
+     */
+    void commit_vote(point_t const &p) {
+        remember(p, 0, _counters.cols());
+        ++_votes;
+    }
 
-        std::vector<line_t> found;
+    /**
+     * @brief Record the withdrawal of a vote whose columns have all
+     * been untallied.
+     *
+     * @param p the point unvoted
+     */
+    void commit_unvote(point_t const &p) {
+        forget(p);
+        --_votes;
+    }
 
-        std::size_t theta;
-        double rho;
+    /**
+     * @brief Remember a vote in effect, for @ref reset().
+     *
+     * Once the votes remembered cover enough cells that clearing
+     * their sinusoids one cell at a time would cost more than
+     * clearing the whole matrix, the accumulator stops remembering
+     * until the next reset.
+     *
+     * @param p the point voted
+     *
+     * @param first the first column voted
+     *
+     * @param count the number of columns voted, taken modulo max_theta
+     */
+    void remember(point_t const &p, std::size_t first, std::size_t count) {
+        if (_saturated) return;
+
+        if ((_dirty_cells + count) * scatter_cost >=
+            _counters.rows() * _counters.cols()) {
+            _saturated = true;
+            _voted.clear();
+            _dirty_cells = 0;
+            return;
+        }
+
+        _voted.push_back(dirty_t{p, first, count});
+        _dirty_cells += count;
+    }
+
+    /**
+     * @brief Forget a vote that has been withdrawn.
+     *
+     * The log holds few entries, so it is searched from the most
+     * recent one.
+     *
+     * @param p the point unvoted
+     */
+    void forget(point_t const &p) {
+        if (_saturated) return;
+
+        for (auto i = _voted.size(); i-- > 0;) {
+            if (_voted[i].point != p) continue;
+
+            _dirty_cells -= _voted[i].count;
+            _voted[i] = _voted.back();
+            _voted.pop_back();
+            return;
+        }
+    }
+
+    /**
+     * @brief Test whether @ref reset() will clear the whole matrix.
+     *
+     * @return true if the votes in effect cover too many cells to be
+     *   cleared one sinusoid at a time
+     */
+    bool saturated() const noexcept {
+        return _saturated;
+    }
+
+    /**
+     * @brief Increment the counters of a range of columns.
+     *
+     * Add the point to the counters for every theta in [@c first, @c
+     * last).  On return, @c n is the larger of its original value and
+     * the largest counter incremented.  The row incremented in each
+     * column is remembered so that @ref conclude() can find the
+     * candidates without repeating the computation.
+     *
+     * Disjoint ranges may be tallied concurrently.
+     *
+     * @param p the point to register
+     *
+     * @param first the first column to update
+     *
+     * @param last one past the last column to update
+     *
+     * @param n the largest count seen so far
+     *
+     * @sa conclude()
+     */
+    void tally(point_t const &p, std::size_t first, std::size_t last,
+               Count &n) {
+        auto const max_rho = _counters.rows();
 
         // Increment the cells in the register, keeping track of the
-        // current maxima.
+        // current maximum.
+
+        while (first < last) {
+            auto const stop = std::min(first + block_size, last);
 
-        for (theta = 0; theta < max_theta; ++theta) {
-            rho = scale_rho(p.dot(_trig[theta]));
-            if (rho < 0 || rho >= max_rho) continue;
+            auto const scaled = _rows_voted.data() + first;
+            _kernel(_trig, p, first, stop, scaled);
 
-            auto &counter = _counters[rho][theta];
+            for (auto theta = first; theta < stop; ++theta) {
+                auto const r = scaled[theta - first];
+                if (r < 0 || r >= static_cast<long>(max_rho)) continue;
 
-            ++counter;
+                auto &&counter = _counters[r][theta];
 
-            // If we have found a new maxima, update n and discard the
-            // old candidates.
+                ++counter;
 
-            if (n < counter) {
-                n = counter;
-                found.clear();
+                n = std::max<Count>(n, counter);
             }
 
-            if (n == counter) {
-                found.emplace_back(theta, unscale_rho(rho));
+            first = stop;
+        }
+    }
+
+    /**
+     * @brief Decrement the counters of a range of columns.
+     *
+     * Disjoint ranges may be updated concurrently.
+     *
+     * @param p the point to unregister
+     *
+     * @param first the first column to update
+     *
+     * @param last one past the last column to update
+     *
+     * @throws std::logic_error if a counter would drop below zero
+     */
+    void untally(point_t const &p, std::size_t first, std::size_t last) {
+        auto const max_rho = _counters.rows();
+
+        while (first < last) {
+            auto const stop = std::min(first + block_size, last);
+
+            long scaled[block_size];
+            _kernel(_trig, p, first, stop, scaled);
+
+            for (auto theta = first; theta < stop; ++theta) {
+                auto const r = scaled[theta - first];
+                if (r < 0 || r >= static_cast<long>(max_rho)) continue;
+
+                auto &&counter = _counters[r][theta];
+
+                if (counter == 0) {
+                    throw std::logic_error{"unvote"};
+                }
+
+                --counter;
             }
+
+            first = stop;
         }
+    }
 
-        ++_votes;
+    /**
+     * @brief Apply the threshold test to a tallied vote.
+     *
+     * @param n the largest count produced by @ref tally(), starting
+     *   from zero
+     *
+     * @param observer told of the threshold test
+     *
+     * @return true if @c n reaches min_trigger_points and the null
+     *   hypothesis is rejected
+     */
+    template <class Observer>
+    bool passes(Count n, Observer &observer) {
+        return passes(n, _votes, observer);
+    }
 
+    /**
+     * @brief Apply the threshold test to a tallied vote, given the
+     * number of votes in effect.
+     *
+     * @param votes the number of votes in effect in the column of the
+     *   count
+     */
+    template <class Observer>
+    bool passes(Count n, std::size_t votes, Observer &observer) {
         // If we do not have a candidate line, stop.
 
-        if (found.empty()) return false;
+        if (n < _min_trigger_points) return false;
+
+        // If the probability of a bin filled randomly containing a
+        // count of n is above the significance threshold, we assume
+        // that the bin was filled by noise and tell the caller we did
+        // not find a segment.
+
+        auto const reject = significant(n, votes);
+
+        observer.tested(reject);
+
+        return reject;
+    }
+
+    /**
+     * @brief Get the number of votes in effect in a column.
+     *
+     * @param theta the column
+     *
+     * @return the number of votes made in every column plus that of
+     *   the oriented votes covering @c theta
+     */
+    std::size_t votes_at(std::size_t theta) const noexcept {
+        return _votes + (_coverage.empty() ? 0 : _coverage[theta]);
+    }
+
+    /**
+     * @brief Call a function for each contiguous range of a run of
+     * columns taken modulo max_theta.
+     *
+     * @param first the first column
+     *
+     * @param count the number of columns; at most max_theta
+     *
+     * @param f a function taking the first and one past the last
+     *   column of a range
+     */
+    template <class F>
+    void for_each_range(std::size_t first, std::size_t count, F &&f) const {
+        auto const max_theta = _counters.cols();
+        auto const last = first + count;
+
+        if (last > max_theta) {
+            f(first, max_theta);
+            f(0, last - max_theta);
+        }
+        else {
+            f(first, last);
+        }
+    }
+
+    /**
+     * @brief Get the columns within a tolerance of an orientation.
+     *
+     * @param orientation the angle of the normal to the line, in
+     *   radians; any value, taken modulo a semiturn
+     *
+     * @param tolerance the largest difference in angle, in radians
+     *
+     * @return the first column and the number of columns, at most
+     *   max_theta
+     */
+    std::pair<std::size_t, std::size_t>
+    window(double orientation, double tolerance) const noexcept {
+        auto const max_theta = _counters.cols();
+        auto const parts = max_theta / (4.0 * std::atan2(1, 1));
+
+        auto const centre = std::lround(orientation * parts) %
+                            static_cast<long>(max_theta);
+        auto const half = static_cast<std::size_t>(
+            std::ceil(std::max(tolerance, 0.0) * parts));
+
+        if (2 * half + 1 >= max_theta) return {0, max_theta};
+
+        auto const first = (centre + static_cast<long>(max_theta) * 2 -
+                            static_cast<long>(half)) %
+                           static_cast<long>(max_theta);
+
+        return {static_cast<std::size_t>(first), 2 * half + 1};
+    }
+
+    /**
+     * @brief Collect the candidates of a tallied vote.
+     *
+     * The candidates are the cells of the last point tallied whose
+     * count equals @c n, as theta and unscaled rho, in order of theta.
+     * Only the columns [@c first, @c first + @c count), taken modulo
+     * max_theta, are searched, so only those need have been tallied
+     * for that point.
+     *
+     * @param n the count of the candidates
+     *
+     * @param first the first column to search
+     *
+     * @param count the number of columns to search; at most
+     *   max_theta
+     *
+     * @return the candidates, valid until the next call
+     */
+    std::vector<std::pair<std::size_t, double>> &
+    candidates(Count n, std::size_t first, std::size_t count) {
+        auto const max_rho = _counters.rows();
+        auto const max_theta = _counters.cols();
+
+        _found.clear();
+
+        auto const collect = [&](std::size_t lo, std::size_t hi) {
+            for (auto theta = lo; theta < hi; ++theta) {
+                auto const r = _rows_voted[theta];
+                if (r < 0 || r >= static_cast<long>(max_rho)) continue;
+
+                if (_counters[r][theta] == n) {
+                    _found.emplace_back(theta, unscale_rho(r));
+                }
+            }
+        };
 
-        // There are max_theta * max_rho cells in the register.
-        // Each vote will increment max_theta of these cells, one
-        // per column.
-        //
-        // Assuming the null hypothesis (the image is random noise),
-        // E[n] = votes/max_rho for all cells in the register.
+        // Collect the part of a range that wraps past the last column
+        // first.
 
-        double const lambda = static_cast<double>(_votes) / max_rho;
+        auto const last = first + count;
 
-        // For the null hypothesis, the cells are filled (roughly)
-        // according to a Poisson model:
-        //
-        //    p(n) = λⁿ/n!·exp(-λ)
-        //         = λⁿ/Γ(n+1)·exp(-λ)
-        // ln p(n) = n·ln(λ) - lnΓ(n+1) - λ
+        if (last > max_theta) collect(0, last - max_theta);
+        collect(first, std::min(last, max_theta));
 
-        double const lnp =
-            n * std::log(lambda) - std::lgamma(n + 1) - lambda;
+        return _found;
+    }
 
-        // lnp is the log probability that a bin filled randomly would
-        // contain a count of n. If the probability is above the
-        // significance threshold, we assume that the bin was filled
-        // by noise and tell the caller we did not find a segment.
+    /**
+     * @brief Test the null hypothesis for a tallied vote.
+     *
+     * Called after every column has been tallied and @ref _votes has
+     * been updated.  Only if the test passes are the candidates, the
+     * cells of the vote whose count equals @c n, collected (in order
+     * of theta).
+     *
+     * @param n the largest count produced by @ref tally(), starting
+     *   from zero
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @param observer told of the threshold test and of a rejected
+     *   cluster
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     */
+    template <class Observer>
+    bool conclude(Count n, segment_t &segment, Observer &observer) {
+        return conclude(n, segment, observer, 0, _counters.cols());
+    }
+
+    /**
+     * @brief Test the null hypothesis for a vote tallied in some
+     * columns only.
+     *
+     * As above, but only the columns [@c first, @c first + @c count),
+     * taken modulo max_theta, are searched for candidates; @c n must
+     * be the largest count the vote produced in those columns.  The
+     * threshold test counts the votes in effect in the middle column;
+     * see @ref votes_at().
+     *
+     * @param first the first column tallied
+     *
+     * @param count the number of columns tallied; at most max_theta
+     */
+    template <class Observer>
+    bool conclude(Count n, segment_t &segment, Observer &observer,
+                  std::size_t first, std::size_t count) {
+        auto const max_theta = _counters.cols();
 
-        if (lnp >= _log_threshold) return false;
+        std::size_t theta;
+        double rho;
+
+        if (!passes(n, votes_at((first + count / 2) % max_theta), observer)) {
+            return false;
+        }
 
         // Reject the null hypothesis.
 
+        auto &found = candidates(n, first, count);
+
         if (found.size() == 1) {
             std::tie(theta, rho) = found.at(0);
         }
@@ -433,7 +985,10 @@ class accumulator {
             // in the cluster, then the range is continuous and it is
             // safe to take the median value.  Otherwise, return.
 
-            if (diff != found.size()) return false;
+            if (diff != found.size()) {
+                observer.rejected_cluster();
+                return false;
+            }
 
             auto median = begin + diff / 2;
             std::tie(theta, rho) = *median;
@@ -450,29 +1005,255 @@ class accumulator {
         return true;
     }
 
+  public:
     /**
-     * Update the register by undoing a previous call to @ref vote().
+     * @brief Get the number of parts per semiturn.
      *
-     * @param p the point to unregister
+     * @return the width of the counter matrix
      */
-    void unvote(point_t const &p) {
+    std::size_t max_theta() const noexcept {
+        return _counters.cols();
+    }
+
+    /**
+     * @brief Reseed the random number generator.
+     *
+     * @param seed the new seed for the URBG
+     */
+    void seed(seed_t seed) {
+        _urbg.seed(seed);
+    }
+
+    /**
+     * @brief Withdraw all votes.
+     *
+     * Every nonzero counter was incremented by a vote still in
+     * effect, so zeroing the cells on the sinusoids of those votes
+     * clears the matrix at a cost proportional to the number of
+     * votes in effect.  If they cover enough cells that clearing the
+     * whole matrix is cheaper, it is cleared instead.
+     */
+    void reset() {
         auto const max_rho = _counters.rows();
         auto const max_theta = _counters.cols();
 
-        for (std::size_t theta = 0; theta < max_theta; ++theta) {
-            double const rho = scale_rho(p.dot(_trig[theta]));
-            if (rho < 0 || rho >= max_rho) continue;
+        auto const clear = [&](point_t const &p, std::size_t first,
+                               std::size_t last) {
+            while (first < last) {
+                auto const stop = std::min(first + block_size, last);
 
-            auto &counter = _counters[rho][theta];
+                long scaled[block_size];
+                _kernel(_trig, p, first, stop, scaled);
 
-            if (counter == 0) {
-                throw std::logic_error{__func__};
+                for (auto theta = first; theta < stop; ++theta) {
+                    auto const r = scaled[theta - first];
+                    if (r < 0 || r >= static_cast<long>(max_rho)) continue;
+
+                    _counters[r][theta] = 0;
+                }
+
+                first = stop;
             }
+        };
 
-            --counter;
+        if (!_saturated) {
+            for (auto &&entry : _voted) {
+                for_each_range(entry.first, entry.count,
+                               [&](std::size_t first, std::size_t last) {
+                                   clear(entry.point, first, last);
+                               });
+            }
+        }
+        else {
+            for (std::size_t r = 0; r < max_rho; ++r) {
+                auto &&row = _counters[r];
+                for (std::size_t theta = 0; theta < max_theta; ++theta) {
+                    row[theta] = 0;
+                }
+            }
         }
 
-        --_votes;
+        _voted.clear();
+        _dirty_cells = 0;
+        _saturated = false;
+        _votes = 0;
+
+        std::fill(_coverage.begin(), _coverage.end(), 0);
+    }
+
+    /**
+     * @brief Add all lines passing through the given point to the
+     * accumulator.
+     *
+     * Returns true if the likelihood of the largest count in the
+     * register exceeds the threshold.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     *
+     * @see unvote()
+     */
+    bool vote(point_t const &p, segment_t &segment) {
+        null_observer observer;
+        return vote(p, segment, observer);
+    }
+
+    /**
+     * @brief Vote a point, reporting the threshold test to an
+     * observer.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @param observer the observer; see @ref null_observer
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     */
+    template <class Observer>
+    bool vote(point_t const &p, segment_t &segment, Observer &observer) {
+        Count n = 0;
+
+        tally(p, 0, _counters.cols(), n);
+
+        commit_vote(p);
+
+        return conclude(n, segment, observer);
+    }
+
+    /**
+     * Update the register by undoing a previous call to @ref vote().
+     *
+     * @param p the point to unregister
+     */
+    void unvote(point_t const &p) {
+        untally(p, 0, _counters.cols());
+
+        commit_unvote(p);
+    }
+
+    /**
+     * @brief Add the lines through a point within a tolerance of an
+     * orientation.
+     *
+     * Only the columns whose angle is within @c tolerance of @c
+     * orientation are updated, so the vote costs in proportion to the
+     * width of the window rather than to max_theta.  The orientation
+     * is that of the normal to the line, which for an edge pixel is
+     * the direction of the gradient.
+     *
+     * The null hypothesis is tested with the number of votes in
+     * effect in the column of @c orientation: the votes made in every
+     * column and the oriented votes whose window covers it.
+     *
+     * @param p the point to register
+     *
+     * @param orientation the angle of the normal, in radians; taken
+     *   modulo a semiturn
+     *
+     * @param tolerance the largest difference in angle voted, in
+     *   radians
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @param observer the observer; see @ref null_observer
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     *
+     * @see unvote(point_t const &, double, double)
+     */
+    template <class Observer>
+    bool vote(point_t const &p, double orientation, double tolerance,
+              segment_t &segment, Observer &observer) {
+        auto const range = window(orientation, tolerance);
+
+        if (_coverage.empty()) _coverage.resize(_counters.cols());
+
+        Count n = 0;
+
+        for_each_range(range.first, range.second,
+                       [&](std::size_t first, std::size_t last) {
+                           tally(p, first, last, n);
+                           for (auto theta = first; theta < last; ++theta) {
+                               ++_coverage[theta];
+                           }
+                       });
+
+        remember(p, range.first, range.second);
+
+        return conclude(n, segment, observer, range.first, range.second);
+    }
+
+    /**
+     * @brief Add the lines through a point within a tolerance of an
+     * orientation.
+     *
+     * Equivalent to the overload taking an observer, with a @ref
+     * null_observer.
+     */
+    bool vote(point_t const &p, double orientation, double tolerance,
+              segment_t &segment) {
+        null_observer observer;
+        return vote(p, orientation, tolerance, segment, observer);
+    }
+
+    /**
+     * @brief Undo a previous call to @ref vote() with an orientation.
+     *
+     * @param p the point to unregister
+     *
+     * @param orientation the orientation it was voted with
+     *
+     * @param tolerance the tolerance it was voted with
+     *
+     * @throws std::logic_error if a counter would drop below zero, or
+     *   if no oriented vote covering the window is in effect
+     */
+    void unvote(point_t const &p, double orientation, double tolerance) {
+        auto const range = window(orientation, tolerance);
+
+        auto const uncovered = [&] {
+            if (_coverage.empty()) return true;
+
+            bool found = false;
+
+            for_each_range(range.first, range.second,
+                           [&](std::size_t first, std::size_t last) {
+                               for (auto theta = first; theta < last;
+                                    ++theta) {
+                                   found |= _coverage[theta] == 0;
+                               }
+                           });
+
+            return found;
+        };
+
+        if (uncovered()) throw std::logic_error{"unvote"};
+
+        for_each_range(range.first, range.second,
+                       [&](std::size_t first, std::size_t last) {
+                           untally(p, first, last);
+                       });
+
+        // Only once every counter has been decremented.
+
+        for_each_range(range.first, range.second,
+                       [&](std::size_t first, std::size_t last) {
+                           for (auto theta = first; theta < last; ++theta) {
+                               --_coverage[theta];
+                           }
+                       });
+
+        forget(p);
     }
 };
 
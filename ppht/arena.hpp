@@ -0,0 +1,265 @@
+#ifndef ppht_arena_hpp
+#define ppht_arena_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace ppht {
+
+/**
+ * @brief A region of memory handed out by bumping a pointer.
+ *
+ * Memory is obtained from the heap in chunks of at least the size
+ * given to the constructor and carved up in order; deallocating is a
+ * no-op.  @ref release() reclaims everything at once: the chunks are
+ * kept and reused, so once an arena has grown to the size a frame
+ * needs, later frames run without touching the heap.  The chunks are
+ * returned to the heap when the arena is destroyed.
+ *
+ * An arena is not thread-safe.  Give each thread its own, which also
+ * keeps the threads off the lock of the global heap.
+ *
+ * @see arena_allocator, which adapts an arena to the containers of the
+ *   standard library
+ */
+class monotonic_arena {
+    /// The header of a chunk, followed by its memory.
+    struct chunk {
+        /// The next chunk in the list.
+        chunk *next;
+
+        /// The number of bytes following the header.
+        std::size_t size;
+
+        /// The first byte of the memory of the chunk.
+        char *begin() noexcept {
+            return reinterpret_cast<char *>(this + 1);
+        }
+    };
+
+    /// The smallest chunk obtained from the heap.
+    std::size_t _chunk_size;
+
+    /// The chunks, in the order they are used.
+    chunk *_chunks = nullptr;
+
+    /// The chunk being carved up.
+    chunk *_current = nullptr;
+
+    /// The next free byte of the current chunk.
+    char *_cursor = nullptr;
+
+    /// One past the last byte of the current chunk.
+    char *_end = nullptr;
+
+    /// The total size of the chunks.
+    std::size_t _capacity = 0;
+
+    /**
+     * @brief Make a chunk the current one.
+     *
+     * @param c the chunk
+     */
+    void enter(chunk *c) noexcept {
+        _current = c;
+        _cursor = c->begin();
+        _end = _cursor + c->size;
+    }
+
+    /**
+     * @brief Move to a chunk that can hold an allocation.
+     *
+     * The chunks after the current one are tried first; a new chunk
+     * is inserted after the current one if none is large enough.
+     *
+     * @param bytes the size of the allocation
+     *
+     * @param align the alignment of the allocation
+     *
+     * @throws std::bad_alloc if the heap is exhausted
+     */
+    void advance(std::size_t bytes, std::size_t align) {
+        auto const need = bytes + align;
+
+        chunk **link = _current ? &_current->next : &_chunks;
+
+        while (*link) {
+            if ((*link)->size >= need) {
+                enter(*link);
+                return;
+            }
+
+            link = &(*link)->next;
+        }
+
+        auto const size = std::max(_chunk_size, need);
+        auto const c =
+            static_cast<chunk *>(::operator new(sizeof(chunk) + size));
+
+        c->size = size;
+        c->next = _current ? _current->next : _chunks;
+        (_current ? _current->next : _chunks) = c;
+        _capacity += size;
+
+        enter(c);
+    }
+
+  public:
+    /**
+     * @brief Create an empty arena.
+     *
+     * No memory is obtained until the first allocation.
+     *
+     * @param chunk_size the smallest number of bytes obtained from the
+     *   heap at a time
+     */
+    explicit monotonic_arena(std::size_t chunk_size = 64 * 1024) noexcept
+        : _chunk_size(std::max<std::size_t>(chunk_size, 1)) {}
+
+    monotonic_arena(monotonic_arena const &) = delete;
+    monotonic_arena &operator=(monotonic_arena const &) = delete;
+
+    /// Return the chunks to the heap.
+    ~monotonic_arena() {
+        while (_chunks) {
+            auto const next = _chunks->next;
+            ::operator delete(_chunks);
+            _chunks = next;
+        }
+    }
+
+    /**
+     * @brief Allocate memory from the arena.
+     *
+     * @param bytes the number of bytes
+     *
+     * @param align the alignment, a power of two no larger than that
+     *   of @c std::max_align_t
+     *
+     * @return the memory, valid until @ref release() or the
+     *   destruction of the arena
+     *
+     * @throws std::bad_alloc if the heap is exhausted
+     */
+    void *allocate(std::size_t bytes, std::size_t align) {
+        auto const padding = [&] {
+            auto const p = reinterpret_cast<std::uintptr_t>(_cursor);
+            return static_cast<std::size_t>(-p & (align - 1));
+        };
+
+        if (!_cursor ||
+            static_cast<std::size_t>(_end - _cursor) < padding() + bytes) {
+            advance(bytes, align);
+        }
+
+        auto const p = _cursor + padding();
+        _cursor = p + bytes;
+
+        return p;
+    }
+
+    /**
+     * @brief Reclaim all the memory allocated from the arena.
+     *
+     * Everything allocated so far becomes invalid.  The chunks are
+     * kept for later allocations.
+     */
+    void release() noexcept {
+        if (_chunks) enter(_chunks);
+    }
+
+    /**
+     * @brief Get the memory obtained from the heap.
+     *
+     * @return the total size of the chunks in bytes
+     */
+    std::size_t capacity() const noexcept {
+        return _capacity;
+    }
+};
+
+/**
+ * @brief An allocator drawing from a @ref monotonic_arena.
+ *
+ * The allocator refers to the arena, which must outlive every
+ * container using it.  Deallocation is a no-op; the memory is
+ * reclaimed by @ref monotonic_arena::release().  Two allocators are
+ * equal if they refer to the same arena.
+ *
+ * @tparam T the type of the elements allocated
+ */
+template <class T>
+class arena_allocator {
+    /// The arena allocated from.
+    monotonic_arena *_arena;
+
+  public:
+    /// The type of the elements allocated.
+    using value_type = T;
+
+    /**
+     * @brief Create an allocator drawing from an arena.
+     *
+     * @param arena the arena
+     */
+    arena_allocator(monotonic_arena &arena) noexcept : _arena(&arena) {}
+
+    /**
+     * @brief Create an allocator drawing from the arena of another.
+     *
+     * @param other the allocator to copy
+     */
+    template <class U>
+    arena_allocator(arena_allocator<U> const &other) noexcept
+        : _arena(&other.arena()) {}
+
+    /**
+     * @brief Get the arena.
+     *
+     * @return the arena allocated from
+     */
+    monotonic_arena &arena() const noexcept {
+        return *_arena;
+    }
+
+    /**
+     * @brief Allocate an array of elements.
+     *
+     * @param n the number of elements
+     *
+     * @return the uninitialized elements
+     *
+     * @throws std::bad_alloc if the heap is exhausted
+     */
+    T *allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc{};
+        }
+
+        return static_cast<T *>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /// Do nothing; the memory is reclaimed with the arena.
+    void deallocate(T *, std::size_t) noexcept {}
+};
+
+/// Test whether two allocators draw from the same arena.
+template <class T, class U>
+bool operator==(arena_allocator<T> const &a,
+                arena_allocator<U> const &b) noexcept {
+    return &a.arena() == &b.arena();
+}
+
+/// Test whether two allocators draw from different arenas.
+template <class T, class U>
+bool operator!=(arena_allocator<T> const &a,
+                arena_allocator<U> const &b) noexcept {
+    return !(a == b);
+}
+
+} // namespace ppht
+
+#endif /* ppht_arena_hpp */
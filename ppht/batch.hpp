@@ -0,0 +1,278 @@
+#ifndef ppht_batch_hpp
+#define ppht_batch_hpp
+
+#include <ppht.hpp>
+#include <ppht/thread_pool.hpp>
+#include <ppht/tiled.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief The tunable parameters of the batch driver.
+ *
+ * @sa find_segments_batch()
+ */
+struct batching {
+    /**
+     * @brief The number of threads to use.
+     *
+     * Zero selects the hardware concurrency.
+     */
+    std::size_t threads = 0;
+
+    /**
+     * @brief The number of accumulators each thread keeps for reuse.
+     *
+     * An accumulator serves only images of the size it was built
+     * for; when a thread meets a new size with its cache full, the
+     * least recently used accumulator is dropped.  Zero disables
+     * reuse.
+     */
+    std::size_t cache_size = 4;
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param threads the new value for @ref threads
+     *
+     * @return the batching object
+     */
+    batching &set_threads(std::size_t threads) {
+        this->threads = threads;
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param cache_size the new value for @ref cache_size
+     *
+     * @return the batching object
+     */
+    batching &set_cache_size(std::size_t cache_size) {
+        this->cache_size = cache_size;
+        return *this;
+    }
+};
+
+/**
+ * @brief The resources reused by one thread of the batch driver.
+ *
+ * @tparam Accumulator the class of the accumulators
+ */
+template <class Accumulator>
+class batch_worker {
+    /// A cached accumulator and the size of image it serves.
+    struct entry {
+        /// The height of the images.
+        std::size_t rows;
+
+        /// The width of the images.
+        std::size_t cols;
+
+        /// The accumulator, holding no votes.
+        std::unique_ptr<Accumulator> accumulator;
+    };
+
+    /// The cached accumulators, most recently used first.
+    std::vector<entry> _cache;
+
+    /// The largest number of accumulators kept.
+    std::size_t _capacity;
+
+  public:
+    /// Scratch storage for the channel scans of every image.
+    scan_buffer buffer;
+
+    /**
+     * @brief Create a worker with an empty cache.
+     *
+     * @param capacity the largest number of accumulators kept
+     */
+    explicit batch_worker(std::size_t capacity) : _capacity(capacity) {}
+
+    /**
+     * @brief Get an accumulator for an image.
+     *
+     * A cached accumulator of the right size is reset and reseeded;
+     * otherwise a new one is constructed and cached, evicting the
+     * least recently used one if the cache is full.  Either way the
+     * accumulator behaves as one newly constructed with the same
+     * arguments.
+     *
+     * @param rows the height of the image
+     *
+     * @param cols the width of the image
+     *
+     * @param param parameters controlling the operation of the accumulator
+     *
+     * @param seed the seed for the random number generator of the
+     *   accumulator
+     *
+     * @return the accumulator, valid until the next call
+     */
+    Accumulator &acquire(std::size_t rows, std::size_t cols,
+                         parameters const &param,
+                         std::random_device::result_type seed) {
+        auto const it =
+            _capacity == 0
+                ? _cache.end()
+                : std::find_if(_cache.begin(), _cache.end(),
+                               [&](entry const &e) {
+                                   return e.rows == rows && e.cols == cols;
+                               });
+
+        if (it != _cache.end()) {
+            // Move the entry to the front.
+
+            std::rotate(_cache.begin(), it, it + 1);
+
+            auto &acc = *_cache.front().accumulator;
+
+            acc.reset();
+            acc.seed(seed);
+
+            return acc;
+        }
+
+        std::unique_ptr<Accumulator> acc{
+            new Accumulator{rows, cols, param, seed}};
+
+        // The accumulator in use is kept even if the cache is disabled.
+
+        if (_cache.size() >= std::max<std::size_t>(_capacity, 1)) {
+            _cache.pop_back();
+        }
+
+        _cache.insert(_cache.begin(), entry{rows, cols, std::move(acc)});
+
+        return *_cache.front().accumulator;
+    }
+};
+
+/**
+ * @brief Run the PPHT algorithm on a batch of independent images.
+ *
+ * Each state in the range is processed as by @ref find_segments(),
+ * with an accumulator seeded by @ref derive_seed() from @c seed and
+ * the position of the state in the range.  The segments of every
+ * state are returned in input order and do not depend on the number
+ * of threads or on the schedule.
+ *
+ * The states are handed to the threads of a @ref thread_pool largest
+ * first: each thread claims the next one as soon as it finishes the
+ * last, so a few large images do not hold up the end of the batch.
+ * Each thread owns a @ref batch_worker holding its scratch storage
+ * and a small cache of accumulators (see @ref batching::cache_size),
+ * so a batch of similar images constructs only one accumulator per
+ * size per thread.
+ *
+ * @tparam RandomIt a random-access iterator over the states, such as
+ *   @ref state objects; they are consumed as by @ref find_segments()
+ *
+ * @tparam Accumulator the class to use for the accumulators
+ *
+ * @param first the first state
+ *
+ * @param last one past the last state
+ *
+ * @param options the threads and caching of the driver
+ *
+ * @param param tuning parameters for every image
+ *
+ * @param seed a value from which the seeds of the images are derived
+ *
+ * @return the segments found in each state, in input order
+ *
+ * @throws any exception thrown while processing a state, once every
+ *   other state has been processed; if several states throw, one of
+ *   the exceptions is rethrown
+ */
+template <class RandomIt, class Accumulator = accumulator<>>
+std::vector<std::vector<segment_t>>
+find_segments_batch(RandomIt first, RandomIt last,
+                    batching const &options = batching{},
+                    parameters const &param = parameters{},
+                    std::random_device::result_type seed =
+                        std::random_device{}()) {
+    std::size_t const count = std::distance(first, last);
+
+    std::vector<std::vector<segment_t>> results(count);
+
+    // Largest first; ties in input order, so the schedule is
+    // reproducible too.
+
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) {
+                         return first[a].rows() * first[a].cols() >
+                                first[b].rows() * first[b].cols();
+                     });
+
+    // No more threads than states.
+
+    auto threads = options.threads;
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+
+    thread_pool pool{std::max<std::size_t>(std::min(threads, count), 1)};
+
+    // One worker per index of the loop, each run by a single thread:
+    // the worker claims states in order until none is left, so it is
+    // never shared.  A state that throws does not stop its worker.
+
+    std::vector<batch_worker<Accumulator>> workers;
+    workers.reserve(pool.size());
+
+    for (std::size_t t = 0; t < pool.size(); ++t) {
+        workers.emplace_back(options.cache_size);
+    }
+
+    std::vector<std::exception_ptr> errors(pool.size());
+    std::atomic<std::size_t> next{0};
+
+    pool.parallel_for(pool.size(), [&](std::size_t t) {
+        auto &worker = workers[t];
+
+        for (;;) {
+            auto const k = next.fetch_add(1, std::memory_order_relaxed);
+            if (k >= count) break;
+
+            auto const index = order[k];
+            auto &&state = first[index];
+
+            try {
+                auto &acc = worker.acquire(state.rows(), state.cols(), param,
+                                           derive_seed(seed, index));
+
+                find_segments(state, acc, param, results[index],
+                              worker.buffer);
+            }
+            catch (...) {
+                if (!errors[t]) errors[t] = std::current_exception();
+            }
+        }
+    });
+
+    for (auto &&error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    return results;
+}
+
+} // namespace ppht
+
+#endif /* ppht_batch_hpp */
@@ -6,6 +6,8 @@
 #include <cstdlib>
 #include <iterator>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace ppht {
 
@@ -43,7 +45,7 @@ struct scanner {
  * @see ppht::make_scanner(segment_t &)
  */
 template <std::size_t Ind>
-struct axis_scanner : scanner {
+struct axis_scanner final : scanner {
     ~axis_scanner() override {}
 
     std::unique_ptr<scanner> clone() const override {
@@ -107,7 +109,7 @@ struct axis_scanner : scanner {
  * @sa https://en.wikipedia.org/wiki/Bresenham's_line_algorithm
  */
 template <std::size_t Ind, int Increment>
-struct bresenham_scanner : scanner {
+struct bresenham_scanner final : scanner {
     /** The index of the dependent field of point_t. */
     static constexpr std::size_t Dep = 1 - Ind;
 
@@ -141,17 +143,28 @@ struct bresenham_scanner : scanner {
 };
 
 /**
- * Factory function to create the appropriate scanner for the given
+ * Call a function with the appropriate scanner for the given
  * segment.  If the segment is not oriented correctly, then it will
  * be corrected by exchanging the endpoints.
  *
+ * The scanner is passed by value as its concrete type, so the
+ * function is instantiated once per type of scanner and calls to
+ * @c advance() can be inlined.
+ *
+ * @tparam F the type of the function
+ *
  * @param segment the segment to scan.
  *
- * @return a pointer to an instance of @ref scanner.
+ * @param f a function taking any of the scanner types
+ *
+ * @return the result of the function.
  *
  * @note this function modifies its arguments.
+ *
+ * @sa make_scanner()
  */
-static inline std::unique_ptr<scanner> make_scanner(segment_t &segment) {
+template <class F>
+static inline auto dispatch_scanner(segment_t &segment, F &&f) {
     auto &a = std::get<0>(segment);
     auto &b = std::get<1>(segment);
 
@@ -169,15 +182,13 @@ static inline std::unique_ptr<scanner> make_scanner(segment_t &segment) {
         }
 
         if (y0 < y1) {
-            return std::unique_ptr<scanner>(
-                new bresenham_scanner<0, +1>{x0, y0, x1, y1});
+            return f(bresenham_scanner<0, +1>{x0, y0, x1, y1});
         }
         else if (y0 == y1) {
-            return std::unique_ptr<scanner>(new axis_scanner<0>{});
+            return f(axis_scanner<0>{});
         }
         else { // y0 > y1
-            return std::unique_ptr<scanner>(
-                new bresenham_scanner<0, -1>{x0, y0, x1, y1});
+            return f(bresenham_scanner<0, -1>{x0, y0, x1, y1});
         }
     }
     else {
@@ -186,19 +197,37 @@ static inline std::unique_ptr<scanner> make_scanner(segment_t &segment) {
         }
 
         if (x0 < x1) {
-            return std::unique_ptr<scanner>(
-                new bresenham_scanner<1, +1>{x0, y0, x1, y1});
+            return f(bresenham_scanner<1, +1>{x0, y0, x1, y1});
         }
         else if (x0 == x1) {
-            return std::unique_ptr<scanner>(new axis_scanner<1>{});
+            return f(axis_scanner<1>{});
         }
         else { // x0 > x1
-            return std::unique_ptr<scanner>(
-                new bresenham_scanner<1, -1>{x0, y0, x1, y1});
+            return f(bresenham_scanner<1, -1>{x0, y0, x1, y1});
         }
     }
 }
 
+/**
+ * Factory function to create the appropriate scanner for the given
+ * segment.  If the segment is not oriented correctly, then it will
+ * be corrected by exchanging the endpoints.
+ *
+ * @param segment the segment to scan.
+ *
+ * @return a pointer to an instance of @ref scanner.
+ *
+ * @note this function modifies its arguments.
+ *
+ * @sa dispatch_scanner()
+ */
+static inline std::unique_ptr<scanner> make_scanner(segment_t &segment) {
+    return dispatch_scanner(segment, [](auto &&s) {
+        using scanner_t = std::decay_t<decltype(s)>;
+        return std::unique_ptr<scanner>(new scanner_t{s});
+    });
+}
+
 /**
  * @brief An abstract container that wraps around a line segment.
  *
@@ -373,6 +402,34 @@ class channel {
         }
     };
 
+    /**
+     * @brief Call a function for every pixel in the channel.
+     *
+     * Visits the same points, in the same order, as the iterators,
+     * but selects the scanner once and runs the whole scan in a
+     * single loop without allocating.
+     *
+     * @tparam F the type of the function
+     *
+     * @param f a function taking a <code>point_t const &</code>
+     *
+     * @sa dispatch_scanner()
+     */
+    template <class F>
+    void for_each(F &&f) const {
+        segment_t segment = _segment;
+
+        dispatch_scanner(segment, [&](auto scanner) {
+            auto point = segment.first;
+
+            for (;;) {
+                f(static_cast<point_t const &>(point));
+                if (point == segment.second) break;
+                scanner.advance(point);
+            }
+        });
+    }
+
     /**
      * @brief An iterator to the first pixel in the channel.
      *
@@ -0,0 +1,317 @@
+#ifndef ppht_coarse_accumulator_hpp
+#define ppht_coarse_accumulator_hpp
+
+#include <ppht/accumulator.hpp>
+#include <ppht/kernel.hpp>
+#include <ppht/observer.hpp>
+#include <ppht/parameters.hpp>
+#include <ppht/raster.hpp>
+#include <ppht/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief An accumulator that screens each vote at a reduced
+ * resolution before testing it at the full one.
+ *
+ * Every vote is tallied into a coarse accumulator with @c factor times
+ * fewer angles; since the rows of the counter matrix are scaled to
+ * match the number of angles, its rho resolution is coarser by the
+ * same factor and a vote costs about @c factor times less.  The coarse
+ * accumulator applies a threshold @c looseness times less strict than
+ * that of @ref parameters::threshold.
+ *
+ * The full-resolution counters are not updated as votes arrive: the
+ * votes and unvotes are logged and replayed, one block of @c factor
+ * columns at a time, only when a coarse bin crosses its threshold.
+ * The blocks around the angles of the coarse bins of the vote with
+ * the largest count are then brought up to date and the usual test
+ * is applied to those columns alone.
+ *
+ * The result is close to, but not the same as, that of @ref
+ * accumulator: a line is only found after its coarse bin passed the
+ * looser threshold, and the angles far from that bin are not searched.
+ * The log grows with the number of votes until @ref reset().
+ *
+ * @tparam Count the type used for the counters
+ *
+ * @tparam Raster the type used for the matrix of counters
+ *
+ * @tparam Kernel the class used to compute rho values while voting
+ */
+template <class Count = std::uint16_t,
+          template <class> class Raster = raster,
+          class Kernel = scalar_kernel>
+class coarse_accumulator : public accumulator<Count, Raster, Kernel> {
+    /// The full-resolution implementation.
+    using base = accumulator<Count, Raster, Kernel>;
+
+    /// The type of seed for the URBG.
+    using seed_t = std::random_device::result_type;
+
+    /// The reduced-resolution accumulator.
+    struct screen_t : base {
+        using base::base;
+        using base::candidates;
+
+        /**
+         * @brief Vote a point and apply the threshold test.
+         *
+         * @param p the point to register
+         *
+         * @param n set to the largest count of the vote
+         *
+         * @return true if the count is significant
+         */
+        bool screen(point_t const &p, Count &n) {
+            n = 0;
+            this->tally(p, 0, this->max_theta(), n);
+            this->commit_vote(p);
+
+            null_observer observer;
+            return this->passes(n, observer);
+        }
+    };
+
+    /// A vote or unvote waiting to be replayed.
+    struct event_t {
+        /// The point voted or unvoted.
+        point_t point;
+
+        /// True for a vote.
+        bool voted;
+    };
+
+    /// The reduced-resolution accumulator.
+    screen_t _screen;
+
+    /// The number of full-resolution columns per coarse column.
+    std::size_t _factor;
+
+    /// Every vote and unvote since the last reset.
+    std::vector<event_t> _log;
+
+    /// The number of events replayed into each block of columns.
+    std::vector<std::size_t> _replayed;
+
+    /**
+     * @brief Get the parameters of the coarse accumulator.
+     *
+     * @throws std::invalid_argument if @c factor does not divide a
+     *   quarter of max_theta
+     */
+    static parameters screen_parameters(parameters param, std::size_t factor,
+                                        double looseness) {
+        if (factor == 0 || param.max_theta % (4 * factor) != 0) {
+            throw std::invalid_argument{"coarse_accumulator: factor"};
+        }
+
+        param.max_theta /= factor;
+        param.threshold = std::min(1.0, param.threshold * looseness);
+
+        return param;
+    }
+
+    /**
+     * @brief Get the first column of a block.
+     *
+     * Block @c b is centred on the column at the angle of coarse
+     * column @c b.
+     *
+     * @param b the index of the block
+     *
+     * @return the first full-resolution column of the block
+     */
+    std::size_t block_first(std::size_t b) const noexcept {
+        auto const max_theta = this->max_theta();
+        return (b * _factor + max_theta - _factor / 2) % max_theta;
+    }
+
+    /**
+     * @brief Replay the events logged since a block was last brought
+     * up to date.
+     *
+     * @param b the index of the block
+     *
+     * @param n set to the larger of its value and the largest count
+     *   produced by the last event, if it is a vote
+     */
+    void replay(std::size_t b, Count &n) {
+        auto const end = _log.size();
+
+        auto const replay_range = [&](std::size_t first, std::size_t last) {
+            for (auto i = _replayed[b]; i < end; ++i) {
+                auto const &event = _log[i];
+
+                if (!event.voted) {
+                    this->untally(event.point, first, last);
+                    continue;
+                }
+
+                Count m = 0;
+                this->tally(event.point, first, last, m);
+                if (i + 1 == end) n = std::max(n, m);
+            }
+        };
+
+        this->for_each_range(block_first(b), _factor, replay_range);
+
+        _replayed[b] = end;
+    }
+
+  public:
+    /**
+     * @brief Construct an instance of @ref coarse_accumulator.
+     *
+     * @param rows the height of the bitmap
+     *
+     * @param cols the width of the bitmap
+     *
+     * @param param parameters controlling the operation of the accumulator
+     *
+     * @param seed the seed for the random number generator used to
+     *        break ties.
+     *
+     * @param factor the reduction in resolution of the coarse
+     *        accumulator; must divide a quarter of max_theta
+     *
+     * @param looseness the factor by which the coarse threshold
+     *        exceeds @ref parameters::threshold
+     *
+     * @throws std::invalid_argument if @c factor does not divide a
+     *   quarter of max_theta
+     */
+    coarse_accumulator(std::size_t rows, std::size_t cols,
+                       parameters const &param,
+                       seed_t seed = std::random_device{}(),
+                       std::size_t factor = 8, double looseness = 1e6)
+        : base(rows, cols, param, seed)
+        , _screen(rows, cols, screen_parameters(param, factor, looseness),
+                  seed)
+        , _factor(factor)
+        , _replayed(param.max_theta / factor) {}
+
+    /**
+     * @brief Get the reduction in resolution of the coarse
+     * accumulator.
+     *
+     * @return the number of full-resolution columns per coarse column
+     */
+    std::size_t factor() const noexcept {
+        return _factor;
+    }
+
+    /// @copydoc accumulator::reset()
+    void reset() {
+        // Clearing the sinusoids of every point voted also clears the
+        // blocks not replayed, which hold none of its counts.
+
+        base::reset();
+        _screen.reset();
+
+        _log.clear();
+        std::fill(_replayed.begin(), _replayed.end(), 0);
+    }
+
+    /**
+     * @brief Add all lines passing through the given point to the
+     * accumulator.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     *
+     * @see accumulator::vote()
+     */
+    bool vote(point_t const &p, segment_t &segment) {
+        null_observer observer;
+        return vote(p, segment, observer);
+    }
+
+    /**
+     * @brief Vote a point, reporting the threshold test to an
+     * observer.
+     *
+     * Only the tests made at full resolution are reported.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @param observer the observer; see @ref null_observer
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     */
+    template <class Observer>
+    bool vote(point_t const &p, segment_t &segment, Observer &observer) {
+        _log.push_back(event_t{p, true});
+        this->commit_vote(p);
+
+        Count n = 0;
+
+        if (!_screen.screen(p, n)) return false;
+
+        // The largest counts of a coarse vote are often tied across
+        // several angles.  Refine the shortest run of coarse columns
+        // holding all of them, widened by one column on each side.
+
+        auto const &found = _screen.candidates(n, 0, _replayed.size());
+        auto const blocks = _replayed.size();
+
+        auto start = found.front().first;
+        auto gap = found.front().first + blocks - found.back().first;
+
+        for (std::size_t i = 1; i < found.size(); ++i) {
+            auto const g = found[i].first - found[i - 1].first;
+            if (g > gap) gap = g, start = found[i].first;
+        }
+
+        auto length = blocks - gap + 3;
+        auto first = (start + blocks - 1) % blocks;
+
+        if (length >= blocks) first = 0, length = blocks;
+
+        n = 0;
+
+        for (std::size_t i = 0; i < length; ++i) {
+            replay((first + i) % blocks, n);
+        }
+
+        return this->conclude(n, segment, observer, block_first(first),
+                              length * _factor);
+    }
+
+    /**
+     * Update the register by undoing a previous call to @ref vote().
+     *
+     * @param p the point to unregister
+     *
+     * @throws std::logic_error if the point was not voted
+     */
+    void unvote(point_t const &p) {
+        _screen.unvote(p);
+        _log.push_back(event_t{p, false});
+
+        // The blocks not yet replayed still hold the vote, so the
+        // point stays remembered for reset().
+
+        --this->_votes;
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_coarse_accumulator_hpp */
@@ -0,0 +1,245 @@
+#ifndef ppht_detector_hpp
+#define ppht_detector_hpp
+
+#include <ppht.hpp>
+#include <ppht/arena.hpp>
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief A reusable instance of the PPHT algorithm.
+ *
+ * Where @ref find_segments() builds a new accumulator (with its
+ * trigonometry table and counter matrix) and a new state raster for
+ * every image, a detector keeps them for the lifetime of the object,
+ * so a stream of images of the same size can be processed without
+ * reallocating or clearing them.  The detector remembers the pixels
+ * marked in the current image and @ref reset() restores only those
+ * cells of the state raster and of the accumulator.  The scratch
+ * storage of @ref postprocess() comes from an arena owned by the
+ * detector, so once the first images have sized every buffer, @ref
+ * detect() does not touch the heap.
+ *
+ * Each call to @ref detect() continues the random sequences of the
+ * previous one; call @ref seed() first for reproducible results.
+ * With the same seed, the first image processed gives the same result
+ * as @ref find_segments().
+ *
+ * @tparam Accumulator the class to use for the accumulator
+ *
+ * @tparam Raster the class to use for the state raster
+ *
+ * @tparam Observer the class of the observer told of the events of
+ *   every run; see @ref null_observer and @ref stats_observer
+ */
+template <class Accumulator = accumulator<>,
+          template <class> class Raster = raster,
+          class Observer = null_observer>
+class detector {
+    /// The type of seed for the random engines.
+    using seed_t = std::random_device::result_type;
+
+    /// Tuning parameters.
+    parameters const _param;
+
+    /// The state of the current image.
+    state<Raster> _state;
+
+    /// The accumulator, reused for every image.
+    Accumulator _accumulator;
+
+    /// The pixels marked pending since the last reset.
+    std::vector<point_t> _touched;
+
+    /// The segments found in the current image.
+    std::vector<segment_t> _segments;
+
+    /// Scratch storage for the channel scans.
+    scan_buffer _buffer;
+
+    /// Scratch storage for postprocessing, released by every run.
+    monotonic_arena _arena;
+
+    /// The observer of the runs.
+    Observer _observer;
+
+  public:
+    /**
+     * @brief Construct a detector.
+     *
+     * @param rows the height of the images
+     *
+     * @param cols the width of the images
+     *
+     * @tparam Param the class of the parameters: @ref parameters, or
+     *   @ref static_parameters to give the accumulator a shared
+     *   trigonometry table
+     *
+     * @param param tuning parameters to adjust the behavior of the
+     *   algorithm
+     *
+     * @param seed a value to use as a seed for the random engines
+     */
+    template <class Param = parameters>
+    detector(std::size_t rows, std::size_t cols,
+             Param const &param = Param{},
+             seed_t seed = std::random_device{}())
+        : _param(param)
+        , _state(rows, cols, seed)
+        , _accumulator(rows, cols, param, seed) {}
+
+    /**
+     * @brief Get the height of the images.
+     *
+     * @return the number of rows of the state raster
+     */
+    std::size_t rows() const {
+        return _state.rows();
+    }
+
+    /**
+     * @brief Get the width of the images.
+     *
+     * @return the number of columns of the state raster
+     */
+    std::size_t cols() const {
+        return _state.cols();
+    }
+
+    /**
+     * @brief Get the observer.
+     *
+     * @return the observer told of the events of every run
+     */
+    Observer &observer() {
+        return _observer;
+    }
+
+    /**
+     * @brief Reseed the random engines.
+     *
+     * @param seed the new seed for the state and the accumulator
+     */
+    void seed(seed_t seed) {
+        _state.seed(seed);
+        _accumulator.seed(seed);
+    }
+
+    /**
+     * @brief Mark a pixel of the current image as set.
+     *
+     * @param point the pixel to mark
+     */
+    void mark_pending(point_t const &point) {
+        _state.mark_pending(point);
+        _touched.push_back(point);
+    }
+
+    /**
+     * @brief Prepare the detector for a new image.
+     *
+     * Clears the accumulator and the pending queue, and returns the
+     * pixels marked since the last reset to @c unset.  The cost is
+     * proportional to the number of pixels marked, not to the size of
+     * the image.
+     *
+     * @sa accumulator::reset(), state::clear_pending()
+     */
+    void reset() {
+        _accumulator.reset();
+        _state.clear_pending();
+
+        for (auto &&point : _touched) _state.mark_unset(point);
+
+        _touched.clear();
+        _segments.clear();
+    }
+
+    /**
+     * @brief Find the segments in the pixels marked since the last
+     * reset.
+     *
+     * @return the segments found; the reference is valid until the
+     *   next call to @ref reset() or @ref detect()
+     *
+     * @sa find_segments()
+     */
+    std::vector<segment_t> const &detect() {
+        _segments.clear();
+        _arena.release();
+
+        // As find_segments(), but with the scratch storage of
+        // postprocess() drawn from the arena.
+
+        for_each_segment(_state, _accumulator, _param, _buffer,
+                         [&](segment_t const &segment) {
+                             _segments.push_back(segment);
+                             return true;
+                         },
+                         _observer);
+
+        _observer.begin_phase(phase_t::postprocessing);
+
+        _segments.erase(postprocess(_segments.begin(), _segments.end(),
+                                    _param.channel_width >> 1, _observer,
+                                    arena_allocator<char>{_arena}),
+                        _segments.end());
+
+        _observer.end_phase(phase_t::postprocessing);
+
+        return _segments;
+    }
+
+    /**
+     * @brief Find the segments in an image.
+     *
+     * Resets the detector, marks every set pixel of the image, and
+     * runs the algorithm.
+     *
+     * The image may be any object providing @c rows(), @c cols() and
+     * @c status(point_t); pixels with status @c pending or @c voted
+     * are considered set.
+     *
+     * @tparam Image the class of the image
+     *
+     * @param frame the image to analyze
+     *
+     * @return the segments found; the reference is valid until the
+     *   next call to @ref reset() or @ref detect()
+     *
+     * @throws std::invalid_argument if the image is not the size of
+     *   the detector
+     */
+    template <class Image>
+    std::vector<segment_t> const &detect(Image const &frame) {
+        if (frame.rows() != rows() || frame.cols() != cols()) {
+            throw std::invalid_argument{"image size does not match detector"};
+        }
+
+        reset();
+
+        point_t p;
+
+        for (p[1] = 0; p[1] < static_cast<long>(rows()); ++p[1]) {
+            for (p[0] = 0; p[0] < static_cast<long>(cols()); ++p[0]) {
+                auto const status = frame.status(p);
+
+                if (status == status_t::pending ||
+                    status == status_t::voted) {
+                    mark_pending(p);
+                }
+            }
+        }
+
+        return detect();
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_detector_hpp */
@@ -0,0 +1,296 @@
+#ifndef ppht_image_view_hpp
+#define ppht_image_view_hpp
+
+#include <ppht/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ppht {
+
+/**
+ * @brief The default predicate of @ref byte_image_view: a pixel is set
+ * if it is not zero.
+ */
+struct nonzero {
+    /**
+     * @brief Test a pixel.
+     *
+     * @param value the value of the pixel
+     *
+     * @return true if the pixel is set
+     */
+    constexpr bool operator()(std::uint8_t value) const noexcept {
+        return value != 0;
+    }
+};
+
+/**
+ * @brief A borrowed view of an image with one byte per pixel.
+ *
+ * The view does not own or copy the pixels; the buffer must outlive
+ * it.  Rows are @c stride bytes apart, so the view can wrap an
+ * OpenCV @c Mat of type @c CV_8UC1, a camera buffer with padded rows,
+ * or a region of a larger image.
+ *
+ * A view may be passed to the @ref state constructor, which builds the
+ * pending queue in a single pass over the buffer, or used anywhere an
+ * image with @c rows(), @c cols() and @c status() is expected.
+ *
+ * @tparam Predicate the test applied to a byte to decide whether the
+ *   pixel is set; with the default @ref nonzero, runs of zero bytes
+ *   are skipped eight at a time
+ */
+template <class Predicate = nonzero>
+class byte_image_view {
+    /// The first byte of the first row.
+    std::uint8_t const *_data;
+
+    /// The height of the image.
+    std::size_t _rows;
+
+    /// The width of the image.
+    std::size_t _cols;
+
+    /// The distance between rows in bytes.
+    std::size_t _stride;
+
+    /// The test for a set pixel.
+    Predicate _predicate;
+
+  public:
+    /**
+     * @brief Create a view.
+     *
+     * @param data the first byte of the first row
+     *
+     * @param rows the height of the image
+     *
+     * @param cols the width of the image
+     *
+     * @param stride the distance between rows in bytes; at least @c
+     *   cols
+     *
+     * @param predicate the test for a set pixel
+     */
+    byte_image_view(void const *data, std::size_t rows, std::size_t cols,
+                    std::size_t stride, Predicate predicate = Predicate{})
+        : _data(static_cast<std::uint8_t const *>(data))
+        , _rows(rows)
+        , _cols(cols)
+        , _stride(stride)
+        , _predicate(predicate) {}
+
+    /**
+     * @brief Get the height of the image.
+     *
+     * @return the number of rows
+     */
+    std::size_t rows() const {
+        return _rows;
+    }
+
+    /**
+     * @brief Get the width of the image.
+     *
+     * @return the number of columns
+     */
+    std::size_t cols() const {
+        return _cols;
+    }
+
+    /**
+     * @brief Get the status of a pixel.
+     *
+     * @param point the pixel to check
+     *
+     * @return @c status_t::pending if the pixel is set, @c
+     *   status_t::unset otherwise
+     */
+    status_t status(point_t const &point) const {
+        auto const value =
+            _data[std::get<1>(point) * _stride + std::get<0>(point)];
+        return _predicate(value) ? status_t::pending : status_t::unset;
+    }
+
+    /**
+     * @brief Call a function for every set pixel, in raster order.
+     *
+     * @tparam F the type of the function
+     *
+     * @param f a function taking a <code>point_t const &</code>
+     */
+    template <class F>
+    void for_each_set(F &&f) const {
+        for (std::size_t y = 0; y < _rows; ++y) {
+            auto const row = _data + y * _stride;
+            std::size_t x = 0;
+
+            if (std::is_same<Predicate, nonzero>::value) {
+                // Skip eight zero pixels at a time.  memcpy keeps the
+                // load legal at any alignment.
+
+                for (; x + 8 <= _cols; x += 8) {
+                    std::uint64_t word;
+                    std::memcpy(&word, row + x, sizeof word);
+
+                    if (word == 0) continue;
+
+                    for (std::size_t i = 0; i < 8; ++i) {
+                        if (row[x + i]) f(point_t(x + i, y));
+                    }
+                }
+            }
+
+            for (; x < _cols; ++x) {
+                if (_predicate(row[x])) f(point_t(x, y));
+            }
+        }
+    }
+};
+
+/**
+ * @brief A borrowed view of an image with one bit per pixel.
+ *
+ * Each row is a sequence of bytes, eight pixels per byte; rows are @c
+ * stride bytes apart.  Within a byte, the first pixel is the least
+ * significant bit (as in X bitmaps) unless @c msb_first is set (as in
+ * PBM files).  Unused bits at the end of a row are ignored.
+ *
+ * @sa byte_image_view
+ */
+class bit_image_view {
+    /// The first byte of the first row.
+    std::uint8_t const *_data;
+
+    /// The height of the image.
+    std::size_t _rows;
+
+    /// The width of the image.
+    std::size_t _cols;
+
+    /// The distance between rows in bytes.
+    std::size_t _stride;
+
+    /// The order of the pixels within a byte.
+    bool _msb_first;
+
+    /**
+     * @brief Get the position of a pixel within its byte.
+     *
+     * @param x the column of the pixel
+     *
+     * @return the index of the bit
+     */
+    unsigned bit(std::size_t x) const noexcept {
+        return _msb_first ? 7 - (x & 7) : (x & 7);
+    }
+
+  public:
+    /**
+     * @brief Create a view.
+     *
+     * @param data the first byte of the first row
+     *
+     * @param rows the height of the image
+     *
+     * @param cols the width of the image
+     *
+     * @param stride the distance between rows in bytes; at least
+     *   <code>(cols + 7) / 8</code>
+     *
+     * @param msb_first true if the first pixel of a byte is its most
+     *   significant bit
+     */
+    bit_image_view(void const *data, std::size_t rows, std::size_t cols,
+                   std::size_t stride, bool msb_first = false)
+        : _data(static_cast<std::uint8_t const *>(data))
+        , _rows(rows)
+        , _cols(cols)
+        , _stride(stride)
+        , _msb_first(msb_first) {}
+
+    /**
+     * @brief Get the height of the image.
+     *
+     * @return the number of rows
+     */
+    std::size_t rows() const {
+        return _rows;
+    }
+
+    /**
+     * @brief Get the width of the image.
+     *
+     * @return the number of columns
+     */
+    std::size_t cols() const {
+        return _cols;
+    }
+
+    /**
+     * @brief Get the status of a pixel.
+     *
+     * @param point the pixel to check
+     *
+     * @return @c status_t::pending if the pixel is set, @c
+     *   status_t::unset otherwise
+     */
+    status_t status(point_t const &point) const {
+        auto const x = static_cast<std::size_t>(std::get<0>(point));
+        auto const byte = _data[std::get<1>(point) * _stride + (x >> 3)];
+        return (byte >> bit(x)) & 1 ? status_t::pending : status_t::unset;
+    }
+
+    /**
+     * @brief Call a function for every set pixel, in raster order.
+     *
+     * Runs of 64 unset pixels are skipped with a single test.
+     *
+     * @tparam F the type of the function
+     *
+     * @param f a function taking a <code>point_t const &</code>
+     */
+    template <class F>
+    void for_each_set(F &&f) const {
+        auto const full_bytes = _cols >> 3;
+
+        for (std::size_t y = 0; y < _rows; ++y) {
+            auto const row = _data + y * _stride;
+            std::size_t b = 0;
+
+            auto const visit = [&](std::size_t b) {
+                unsigned const byte = row[b];
+
+                for (unsigned i = 0; i < 8; ++i) {
+                    if ((byte >> bit(i)) & 1) f(point_t(b * 8 + i, y));
+                }
+            };
+
+            for (; b + 8 <= full_bytes; b += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, row + b, sizeof word);
+
+                if (word == 0) continue;
+
+                for (std::size_t i = 0; i < 8; ++i) {
+                    if (row[b + i]) visit(b + i);
+                }
+            }
+
+            for (; b < full_bytes; ++b) {
+                if (row[b]) visit(b);
+            }
+
+            for (auto x = full_bytes * 8; x < _cols; ++x) {
+                if ((row[x >> 3] >> bit(x)) & 1) f(point_t(x, y));
+            }
+        }
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_image_view_hpp */
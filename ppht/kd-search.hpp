@@ -4,6 +4,9 @@
 #include <ppht/types.hpp>
 
 #include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <vector>
 
 namespace ppht {
 
@@ -29,6 +32,7 @@ namespace ppht {
  * @param p the center of the disc
  * @param limit the radius of the disc
  * @tparam Dim the axis along which the range will be partitioned
+ * @sa kd_tree for repeated queries over the same points
  */
 template <std::size_t Dim = 0, class RandomIt, class OutputIt>
 OutputIt kd_search(RandomIt begin, RandomIt end, OutputIt output,
@@ -84,6 +88,277 @@ OutputIt kd_search(RandomIt begin, RandomIt end, OutputIt output,
     return output;
 }
 
+
+/**
+ * @brief The default key of a @ref kd_tree: the first element of a
+ * tuple-like value, as in @ref kd_search().
+ */
+struct first_element {
+    /**
+     * @brief Get the key of a value.
+     *
+     * @param value the value
+     *
+     * @return the point of the value
+     */
+    template <class T>
+    point_t const &operator()(T const &value) const {
+        return std::get<0>(value);
+    }
+};
+
+/**
+ * @brief A static kd-tree for radius queries.
+ *
+ * Where @ref kd_search() partitions its range on every query, the tree
+ * is partitioned once when it is built and may then be queried any
+ * number of times without disturbing the caller's data.  Elements are
+ * identified by their position in the input sequence; they cannot be
+ * added, but they can be erased, after which queries skip them.
+ *
+ * The tree is implicit: the points are stored in a single array in
+ * which the median of every range is the root of its subtree, with the
+ * axis of the split alternating between x and y.
+ *
+ * @tparam T the type of the elements
+ *
+ * @tparam Key a function object returning the @c point_t of an
+ *   element
+ */
+template <class T, class Key = first_element>
+class kd_tree {
+    /// The elements, in input order.
+    std::vector<T> _values;
+
+    /// The index of the element at each position of the tree.
+    std::vector<std::size_t> _index;
+
+    /// The position in the tree of each element.
+    std::vector<std::size_t> _position;
+
+    /// The point of the element at each position of the tree.
+    std::vector<point_t> _points;
+
+    /// Whether the element at each position of the tree is erased.
+    std::vector<bool> _erased;
+
+    /// The number of elements not erased in the subtree rooted at each
+    /// position; lets queries skip emptied subtrees.
+    std::vector<std::size_t> _live;
+
+    /**
+     * @brief Get the root of a subtree.
+     *
+     * @param begin the first position of the subtree
+     *
+     * @param end one past the last position of the subtree
+     *
+     * @return the position of the median element
+     */
+    static std::size_t root(std::size_t begin, std::size_t end) noexcept {
+        return begin + (end - begin) / 2;
+    }
+
+    /**
+     * @brief Partition a subtree.
+     *
+     * @param points the points in input order
+     *
+     * @param begin the first position of the subtree
+     *
+     * @param end one past the last position of the subtree
+     *
+     * @param dim the axis along which to split
+     *
+     * @return the number of elements in the subtree
+     */
+    std::size_t build(std::vector<point_t> const &points, std::size_t begin,
+                      std::size_t end, std::size_t dim) {
+        if (begin == end) return 0;
+
+        auto const median = root(begin, end);
+
+        std::nth_element(_index.begin() + begin, _index.begin() + median,
+                         _index.begin() + end,
+                         [&](std::size_t a, std::size_t b) {
+                             return points[a][dim] < points[b][dim];
+                         });
+
+        _live[median] = 1 + build(points, begin, median, 1 - dim) +
+                        build(points, median + 1, end, 1 - dim);
+
+        return _live[median];
+    }
+
+    /**
+     * @brief Search a subtree.
+     *
+     * @param begin the first position of the subtree
+     *
+     * @param end one past the last position of the subtree
+     *
+     * @param dim the axis along which the subtree is split
+     *
+     * @param output where to store the indices found
+     *
+     * @param p the center of the disc
+     *
+     * @param limit the radius of the disc
+     *
+     * @return the output iterator past the last index stored
+     */
+    template <class OutputIt>
+    OutputIt search(std::size_t begin, std::size_t end, std::size_t dim,
+                    OutputIt output, point_t const &p, long limit) const {
+        if (begin == end) return output;
+
+        auto const median = root(begin, end);
+
+        if (_live[median] == 0) return output;
+
+        point_t const &midpt = _points[median];
+
+        if (!_erased[median] &&
+            (p - midpt).length_squared() <= limit * limit) {
+            *output = _index[median]; ++output;
+        }
+
+        // As in kd_search(), visit a side only if the disc reaches it.
+
+        auto const d_plane = p[dim] - midpt[dim];
+
+        if (d_plane <= limit) {
+            output = search(begin, median, 1 - dim, output, p, limit);
+        }
+        if (d_plane >= -limit) {
+            output = search(median + 1, end, 1 - dim, output, p, limit);
+        }
+
+        return output;
+    }
+
+  public:
+    /**
+     * @brief Build a tree.
+     *
+     * @tparam InputIt the type of iterator over the elements
+     *
+     * @param first the first element
+     *
+     * @param last one past the last element
+     *
+     * @param key the function returning the point of an element
+     */
+    template <class InputIt>
+    kd_tree(InputIt first, InputIt last, Key key = Key{})
+        : _values(first, last) {
+        auto const n = _values.size();
+
+        std::vector<point_t> points;
+        points.reserve(n);
+
+        _index.resize(n);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            _index[i] = i;
+            points.push_back(key(_values[i]));
+        }
+
+        _erased.assign(n, false);
+        _live.resize(n);
+
+        build(points, 0, n, 0);
+
+        // Lay the points out in tree order for the queries.
+
+        _position.resize(n);
+        _points.resize(n);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            _position[_index[i]] = i;
+            _points[i] = points[_index[i]];
+        }
+    }
+
+    /**
+     * @brief Get the number of elements, including erased ones.
+     *
+     * @return the length of the input sequence
+     */
+    std::size_t size() const {
+        return _values.size();
+    }
+
+    /**
+     * @brief Get an element.
+     *
+     * @param index the position of the element in the input sequence
+     *
+     * @return the element
+     */
+    T const &operator[](std::size_t index) const {
+        return _values[index];
+    }
+
+    /**
+     * @brief Erase an element; later queries will not report it.
+     *
+     * Erasing an element twice has no further effect.
+     *
+     * @param index the position of the element in the input sequence
+     */
+    void erase(std::size_t index) {
+        auto const target = _position[index];
+
+        if (_erased[target]) return;
+
+        _erased[target] = true;
+
+        std::size_t begin = 0, end = _points.size();
+
+        for (;;) {
+            auto const median = root(begin, end);
+
+            --_live[median];
+
+            if (target == median) break;
+            if (target < median) end = median;
+            else begin = median + 1;
+        }
+    }
+
+    /**
+     * @brief Test whether an element has been erased.
+     *
+     * @param index the position of the element in the input sequence
+     *
+     * @return true if @ref erase() has been called for the element
+     */
+    bool erased(std::size_t index) const {
+        return _erased[_position[index]];
+    }
+
+    /**
+     * @brief Find the elements within a disc.
+     *
+     * Finds the elements not erased whose points lie in the closed
+     * disc centered at @c p with radius @c limit.  The order of the
+     * results is unspecified but depends only on the input sequence.
+     *
+     * @param output where to store the indices of the elements found
+     *
+     * @param p the center of the disc
+     *
+     * @param limit the radius of the disc
+     *
+     * @return the output iterator past the last index stored
+     */
+    template <class OutputIt>
+    OutputIt search(OutputIt output, point_t const &p, long limit) const {
+        return search(0, _points.size(), 0, output, p, limit);
+    }
+};
+
 }
 
 #endif
@@ -0,0 +1,279 @@
+#ifndef ppht_kernel_hpp
+#define ppht_kernel_hpp
+
+#include <ppht/trig.hpp>
+#include <ppht/types.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(PPHT_NO_SIMD)
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace ppht {
+
+/**
+ * @brief The reference implementation of the voting kernel.
+ *
+ * A kernel converts a point into the row indices of the counter
+ * matrix for a block of consecutive theta values, i.e., it computes
+ * @f$\operatorname{rint}(2^e(x\cos\theta + y\sin\theta) + (m-1)/2)@f$
+ * for each @f$\theta@f$ in the block, where @f$(m, e)@f$ is the
+ * result of @ref accumulator::rho_info().  The accumulator performs
+ * the bounds check and the increment.
+ *
+ * Any class with the same constructor and call operator may be used
+ * as the @c Kernel parameter of @ref accumulator.
+ *
+ * @sa simd_kernel
+ */
+class scalar_kernel {
+    /// Exponent by which to scale raw rho values.
+    int _rho_scale;
+
+    /// Translation applied to the scaled rho values.
+    double _offset;
+
+  public:
+    /**
+     * @brief Construct a kernel.
+     *
+     * @param trig the trigonometry table of the accumulator
+     *
+     * @param rho_scale the exponent by which raw rho values are scaled
+     *
+     * @param max_rho the height of the counter matrix
+     */
+    scalar_kernel(trig_table const &trig, int rho_scale,
+                  std::size_t max_rho) noexcept
+        : _rho_scale(rho_scale)
+        , _offset(max_rho >> 1) {
+        static_cast<void>(trig);
+    }
+
+    /**
+     * @brief Compute the scaled rho values of a point.
+     *
+     * On return, <code>rho[i]</code> holds the scaled rho value for
+     * <code>theta = first + i</code>.  The values are not bounds
+     * checked.
+     *
+     * @param trig the trigonometry table of the accumulator
+     *
+     * @param p the point being voted
+     *
+     * @param first the first theta of the block
+     *
+     * @param last one past the last theta of the block
+     *
+     * @param rho the output array, of at least <code>last -
+     *   first</code> elements
+     */
+    void operator()(trig_table const &trig, point_t const &p,
+                    std::size_t first, std::size_t last,
+                    long *rho) const noexcept {
+        auto const c = trig.cos();
+        auto const s = trig.sin();
+
+        for (auto theta = first; theta < last; ++theta) {
+            auto const raw = std::get<0>(p) * c[theta] +
+                             std::get<1>(p) * s[theta];
+            auto const scaled = std::scalbn(raw, _rho_scale);
+            *rho++ = static_cast<long>(std::rint(scaled + _offset));
+        }
+    }
+};
+
+/**
+ * @brief A vectorized implementation of the voting kernel.
+ *
+ * The instruction set is chosen at compile time: AVX-512F, AVX2, or
+ * NEON (AArch64), in that order of preference.  If none is available,
+ * or if @c PPHT_NO_SIMD is defined, the kernel degrades to the loop
+ * of @ref scalar_kernel.
+ *
+ * The arithmetic performed is the same as in @ref scalar_kernel (a
+ * multiplication by a power of two is exact, and the rounding uses
+ * the current rounding mode just as @c std::rint does) so the two
+ * produce identical results.  This assumes the compiler does not
+ * contract the scalar multiply-add into a fused operation; see
+ * @c -ffp-contract.
+ */
+class simd_kernel {
+    /// The scalar implementation, used for the tail of a block.
+    scalar_kernel _scalar;
+
+    /// The multiplier equivalent to scaling by @c rho_scale.
+    double _scale;
+
+    /// Translation applied to the scaled rho values.
+    double _offset;
+
+    static_assert(sizeof(long) == sizeof(std::int64_t),
+                  "vector stores assume a 64-bit long");
+
+  public:
+    /**
+     * @brief Construct a kernel.
+     *
+     * @param trig the trigonometry table of the accumulator
+     *
+     * @param rho_scale the exponent by which raw rho values are scaled
+     *
+     * @param max_rho the height of the counter matrix
+     */
+    simd_kernel(trig_table const &trig, int rho_scale,
+                std::size_t max_rho) noexcept
+        : _scalar(trig, rho_scale, max_rho)
+        , _scale(std::scalbn(1.0, rho_scale))
+        , _offset(max_rho >> 1) {}
+
+    /**
+     * @brief Compute the scaled rho values of a point.
+     *
+     * @param trig the trigonometry table of the accumulator
+     *
+     * @param p the point being voted
+     *
+     * @param first the first theta of the block
+     *
+     * @param last one past the last theta of the block
+     *
+     * @param rho the output array, of at least <code>last -
+     *   first</code> elements
+     *
+     * @sa scalar_kernel::operator()()
+     */
+    void operator()(trig_table const &trig, point_t const &p,
+                    std::size_t first, std::size_t last,
+                    long *rho) const noexcept {
+#if !defined(PPHT_NO_SIMD) && defined(__AVX512F__)
+        auto const x = _mm512_set1_pd(static_cast<double>(std::get<0>(p)));
+        auto const y = _mm512_set1_pd(static_cast<double>(std::get<1>(p)));
+        auto const scale = _mm512_set1_pd(_scale);
+        auto const offset = _mm512_set1_pd(_offset);
+
+        for (; first + 8 <= last; first += 8, rho += 8) {
+            auto const c = _mm512_loadu_pd(trig.cos() + first);
+            auto const s = _mm512_loadu_pd(trig.sin() + first);
+            auto r = _mm512_add_pd(_mm512_mul_pd(x, c), _mm512_mul_pd(y, s));
+            r = _mm512_add_pd(_mm512_mul_pd(r, scale), offset);
+            // The zero-masked forms are used because the unmasked
+            // ones trip -Wmaybe-uninitialized in some GCC headers.
+            r = _mm512_maskz_roundscale_pd(0xFF, r, _MM_FROUND_CUR_DIRECTION);
+            auto const i = _mm512_maskz_cvtepi32_epi64(
+                0xFF, _mm512_maskz_cvtpd_epi32(0xFF, r));
+            _mm512_storeu_si512(rho, i);
+        }
+#elif !defined(PPHT_NO_SIMD) && defined(__AVX2__)
+        auto const x = _mm256_set1_pd(static_cast<double>(std::get<0>(p)));
+        auto const y = _mm256_set1_pd(static_cast<double>(std::get<1>(p)));
+        auto const scale = _mm256_set1_pd(_scale);
+        auto const offset = _mm256_set1_pd(_offset);
+
+        for (; first + 4 <= last; first += 4, rho += 4) {
+            auto const c = _mm256_loadu_pd(trig.cos() + first);
+            auto const s = _mm256_loadu_pd(trig.sin() + first);
+            auto r = _mm256_add_pd(_mm256_mul_pd(x, c), _mm256_mul_pd(y, s));
+            r = _mm256_add_pd(_mm256_mul_pd(r, scale), offset);
+            r = _mm256_round_pd(r, _MM_FROUND_CUR_DIRECTION);
+            auto const i = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(r));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(rho), i);
+        }
+#elif !defined(PPHT_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+        auto const x = vdupq_n_f64(static_cast<double>(std::get<0>(p)));
+        auto const y = vdupq_n_f64(static_cast<double>(std::get<1>(p)));
+        auto const scale = vdupq_n_f64(_scale);
+        auto const offset = vdupq_n_f64(_offset);
+
+        for (; first + 2 <= last; first += 2, rho += 2) {
+            auto const c = vld1q_f64(trig.cos() + first);
+            auto const s = vld1q_f64(trig.sin() + first);
+            auto r = vaddq_f64(vmulq_f64(x, c), vmulq_f64(y, s));
+            r = vaddq_f64(vmulq_f64(r, scale), offset);
+            auto const i = vcvtq_s64_f64(vrndxq_f64(r));
+            vst1q_s64(reinterpret_cast<std::int64_t *>(rho), i);
+        }
+#endif
+        _scalar(trig, p, first, last, rho);
+    }
+};
+
+/**
+ * @brief A voting kernel using fixed-point arithmetic.
+ *
+ * The kernel keeps a @ref fixed_trig_table with the scale and offset
+ * of the accumulator folded in, so each rho value costs two integer
+ * multiplications, an addition and a shift.  The table is half the
+ * size of the floating-point one.
+ *
+ * The results are @b not always identical to those of @ref
+ * scalar_kernel: a rho value lying on or within a few parts in
+ * @f$2^{31}@f$ of a rounding boundary may land in the neighboring
+ * bin.  See @ref fixed_trig_table.
+ */
+class fixed_point_kernel {
+    /// The pre-scaled trigonometry table.
+    fixed_trig_table _table;
+
+  public:
+    /**
+     * @brief Construct a kernel.
+     *
+     * @param trig the trigonometry table of the accumulator
+     *
+     * @param rho_scale the exponent by which raw rho values are scaled
+     *
+     * @param max_rho the height of the counter matrix
+     */
+    fixed_point_kernel(trig_table const &trig, int rho_scale,
+                       std::size_t max_rho)
+        : _table(trig, rho_scale, max_rho) {}
+
+    /**
+     * @brief Compute the scaled rho values of a point.
+     *
+     * The floating-point table is not consulted.
+     *
+     * @param trig the trigonometry table of the accumulator (unused)
+     *
+     * @param p the point being voted
+     *
+     * @param first the first theta of the block
+     *
+     * @param last one past the last theta of the block
+     *
+     * @param rho the output array, of at least <code>last -
+     *   first</code> elements
+     *
+     * @sa scalar_kernel::operator()()
+     */
+    void operator()(trig_table const &trig, point_t const &p,
+                    std::size_t first, std::size_t last,
+                    long *rho) const noexcept {
+        static_cast<void>(trig);
+
+        std::int64_t const x = std::get<0>(p);
+        std::int64_t const y = std::get<1>(p);
+
+        auto const c = _table.cos();
+        auto const s = _table.sin();
+        auto const offset = _table.offset();
+        auto const shift = _table.shift();
+
+        for (auto theta = first; theta < last; ++theta) {
+            *rho++ = static_cast<long>(
+                (x * c[theta] + y * s[theta] + offset) >> shift);
+        }
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_kernel_hpp */
@@ -0,0 +1,245 @@
+#ifndef ppht_mapped_raster_hpp
+#define ppht_mapped_raster_hpp
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ppht {
+
+/**
+ * @brief A 2D array of elements in memory mapped from the kernel.
+ *
+ * The interface is that of @ref raster, so the class can be passed as
+ * the @c Raster parameter of @ref state or @ref accumulator.  Instead
+ * of allocating and zeroing the elements up front, the raster maps
+ * them with @c mmap: pages read as zero until they are first written,
+ * so construction takes constant time and only the pages touched use
+ * memory.  Where available, transparent huge pages are requested with
+ * @c MADV_HUGEPAGE.
+ *
+ * A raster constructed from rows and columns alone is an anonymous
+ * private mapping made with @c MAP_NORESERVE, so it may be larger than
+ * the memory and swap the system would commit.  A raster constructed
+ * with a path is a shared mapping of that file, extended with zeros
+ * to the size of the raster if it is shorter; its pages are written
+ * back to the file rather than to swap, so the raster may exceed the
+ * memory of the machine, and its contents persist.
+ *
+ * Requires POSIX.  Does not perform bounds checking.
+ *
+ * @tparam T the type of elements to store; a trivial type, for which
+ *   zero bytes are a zero value
+ */
+template <class T>
+class mapped_raster {
+    static_assert(std::is_trivial<T>::value,
+                  "mapped_raster requires a trivial element type");
+
+    /// The elements of the raster.
+    T *_data = nullptr;
+
+    /// The length of the mapping in bytes.
+    std::size_t _bytes = 0;
+
+    /// The height of this raster.
+    std::size_t _rows = 0;
+
+    /// The width of this raster.
+    std::size_t _cols = 0;
+
+    /**
+     * @brief Map the elements.
+     *
+     * @param fd the file to map, or -1 for anonymous memory
+     *
+     * @throws std::system_error if the mapping fails
+     */
+    void map(int fd) {
+        if (_bytes == 0) return;
+
+        int flags = fd < 0 ? MAP_PRIVATE | MAP_ANONYMOUS : MAP_SHARED;
+
+#ifdef MAP_NORESERVE
+        if (fd < 0) flags |= MAP_NORESERVE;
+#endif
+
+        auto const p =
+            ::mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+
+        if (p == MAP_FAILED) {
+            throw std::system_error{errno, std::generic_category(), "mmap"};
+        }
+
+#ifdef MADV_HUGEPAGE
+        // Only a hint: failure leaves ordinary pages.
+        ::madvise(p, _bytes, MADV_HUGEPAGE);
+#endif
+
+        _data = static_cast<T *>(p);
+    }
+
+    /// Unmap the elements, if any.
+    void unmap() noexcept {
+        if (_data) ::munmap(_data, _bytes);
+        _data = nullptr;
+    }
+
+  public:
+    /// The type of the cells of this raster.
+    using value_type = T;
+
+    /**
+     * @brief Create a new raster in anonymous memory.
+     *
+     * @param rows the number of rows (height) of the raster.
+     *
+     * @param cols the number of columns (width) of the raster.
+     *
+     * @throws std::system_error if the mapping fails
+     */
+    mapped_raster(std::size_t rows, std::size_t cols)
+        : _bytes(rows * cols * sizeof(T))
+        , _rows(rows)
+        , _cols(cols) {
+        map(-1);
+    }
+
+    /**
+     * @brief Create a new raster backed by a file.
+     *
+     * The file is created if it does not exist.  Existing contents
+     * are kept and become the initial values of the elements.
+     *
+     * @param rows the number of rows (height) of the raster.
+     *
+     * @param cols the number of columns (width) of the raster.
+     *
+     * @param path the path of the file
+     *
+     * @throws std::system_error if the file cannot be opened, extended
+     *   or mapped
+     */
+    mapped_raster(std::size_t rows, std::size_t cols, char const *path)
+        : _bytes(rows * cols * sizeof(T))
+        , _rows(rows)
+        , _cols(cols) {
+        int const fd = ::open(path, O_RDWR | O_CREAT, 0666);
+
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category(), path};
+        }
+
+        struct stat st;
+
+        try {
+            if (::fstat(fd, &st) != 0) {
+                throw std::system_error{errno, std::generic_category(),
+                                        "fstat"};
+            }
+
+            if (static_cast<std::size_t>(st.st_size) < _bytes &&
+                ::ftruncate(fd, static_cast<off_t>(_bytes)) != 0) {
+                throw std::system_error{errno, std::generic_category(),
+                                        "ftruncate"};
+            }
+
+            map(fd);
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+
+        // The mapping keeps the file open.
+
+        ::close(fd);
+    }
+
+    /**
+     * @brief Take over the mapping of another raster.
+     *
+     * @param other the raster to move from; left empty
+     */
+    mapped_raster(mapped_raster &&other) noexcept
+        : _data(std::exchange(other._data, nullptr))
+        , _bytes(std::exchange(other._bytes, 0))
+        , _rows(std::exchange(other._rows, 0))
+        , _cols(std::exchange(other._cols, 0)) {}
+
+    /**
+     * @brief Take over the mapping of another raster.
+     *
+     * @param other the raster to move from; left empty
+     *
+     * @return this raster
+     */
+    mapped_raster &operator=(mapped_raster &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            _data = std::exchange(other._data, nullptr);
+            _bytes = std::exchange(other._bytes, 0);
+            _rows = std::exchange(other._rows, 0);
+            _cols = std::exchange(other._cols, 0);
+        }
+
+        return *this;
+    }
+
+    /// Unmap the elements; a file-backed raster is written back.
+    ~mapped_raster() {
+        unmap();
+    }
+
+    /**
+     * @brief Get the height of the raster.
+     *
+     * @return the number of rows in the raster
+     */
+    std::size_t const &rows() const {
+        return _rows;
+    }
+
+    /**
+     * @brief Get the width of the raster.
+     *
+     * @return the number of columns in the raster
+     */
+    std::size_t const &cols() const {
+        return _cols;
+    }
+
+    /**
+     * @brief Access the specified row of the raster.
+     *
+     * @param row the row number
+     *
+     * @return a pointer to the row, of @ref cols elements
+     */
+    T *operator[](std::size_t row) {
+        return _data + row * _cols;
+    }
+
+    /**
+     * @brief Access the specified row of the raster as a read-only
+     * array.
+     *
+     * @param row the row number
+     *
+     * @return a pointer to the row, of @ref cols elements
+     */
+    T const *operator[](std::size_t row) const {
+        return _data + row * _cols;
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_mapped_raster_hpp */
@@ -0,0 +1,236 @@
+#ifndef ppht_observer_hpp
+#define ppht_observer_hpp
+
+#include <ppht/types.hpp>
+
+#include <chrono>
+#include <cstddef>
+
+namespace ppht {
+
+/// The phases of the algorithm timed by an observer.
+enum class phase_t {
+    voting,                     ///< Voting a pixel.
+    scanning,                   ///< Scanning a channel and consuming
+                                ///  its pixels.
+    postprocessing,             ///< Merging the segments found.
+    count                       ///< The number of phases.
+};
+
+/**
+ * @brief An observer that ignores every event.
+ *
+ * An observer is passed by reference to @ref for_each_segment(), @ref
+ * find_segments(), @ref postprocess() and @ref accumulator::vote(),
+ * which call its members as the events happen.  This one is the
+ * default; its members are empty and inline, so they cost nothing.
+ * An observer must provide every member of this class.
+ *
+ * @sa stats_observer
+ */
+struct null_observer {
+    /// A pixel was voted.
+    void voted() noexcept {}
+
+    /// A pixel was unvoted.
+    void unvoted() noexcept {}
+
+    /**
+     * @brief The null hypothesis was tested for a vote.
+     *
+     * @param significant true if it was rejected
+     */
+    void tested(bool significant) noexcept {
+        (void)significant;
+    }
+
+    /// A significant vote was discarded because the cells with the
+    /// largest count did not form a contiguous range of angles.
+    void rejected_cluster() noexcept {}
+
+    /**
+     * @brief A channel was scanned.
+     *
+     * @param accepted true if the segment found was long enough
+     */
+    void scanned(bool accepted) noexcept {
+        (void)accepted;
+    }
+
+    /**
+     * @brief Pixels were marked @c done.
+     *
+     * @param pixels the number of pixels
+     */
+    void consumed(std::size_t pixels) noexcept {
+        (void)pixels;
+    }
+
+    /// Two segments were merged by @ref postprocess().
+    void merged() noexcept {}
+
+    /**
+     * @brief A phase started.
+     *
+     * @param phase the phase
+     */
+    void begin_phase(phase_t phase) noexcept {
+        (void)phase;
+    }
+
+    /**
+     * @brief A phase ended.
+     *
+     * @param phase the phase
+     */
+    void end_phase(phase_t phase) noexcept {
+        (void)phase;
+    }
+};
+
+/**
+ * @brief An observer that counts the events and times the phases.
+ *
+ * The counts accumulate over every run observed until @ref clear() is
+ * called.  Timing reads @c std::steady_clock twice per vote, which
+ * adds a small fraction to the cost of a vote.
+ */
+struct stats_observer {
+    /// The type of the phase times.
+    using duration = std::chrono::steady_clock::duration;
+
+    /// The number of pixels voted.
+    std::size_t votes = 0;
+
+    /// The number of pixels unvoted.
+    std::size_t unvotes = 0;
+
+    /// The number of votes for which the null hypothesis was tested.
+    std::size_t threshold_tests = 0;
+
+    /// The number of votes that rejected the null hypothesis.
+    std::size_t significant = 0;
+
+    /// The number of significant votes discarded for a broken
+    /// cluster.
+    std::size_t rejected_clusters = 0;
+
+    /// The number of channel scans.
+    std::size_t scans = 0;
+
+    /// The number of channel scans that found a segment long enough.
+    std::size_t accepted_scans = 0;
+
+    /// The number of pixels marked @c done by accepted scans.
+    std::size_t consumed_pixels = 0;
+
+    /// The number of merges made by @ref postprocess().
+    std::size_t merges = 0;
+
+    /// The total time spent in each phase, indexed by @ref phase_t.
+    duration time[static_cast<std::size_t>(phase_t::count)] = {};
+
+    /// Reset every count and time to zero.
+    void clear() noexcept {
+        *this = stats_observer{};
+    }
+
+    /**
+     * @brief Get the time spent in a phase.
+     *
+     * @param phase the phase
+     *
+     * @return the total time
+     */
+    duration elapsed(phase_t phase) const noexcept {
+        return time[static_cast<std::size_t>(phase)];
+    }
+
+    /// @copydoc null_observer::voted()
+    void voted() noexcept {
+        ++votes;
+    }
+
+    /// @copydoc null_observer::unvoted()
+    void unvoted() noexcept {
+        ++unvotes;
+    }
+
+    /// @copydoc null_observer::tested()
+    void tested(bool significant) noexcept {
+        ++threshold_tests;
+        if (significant) ++this->significant;
+    }
+
+    /// @copydoc null_observer::rejected_cluster()
+    void rejected_cluster() noexcept {
+        ++rejected_clusters;
+    }
+
+    /// @copydoc null_observer::scanned()
+    void scanned(bool accepted) noexcept {
+        ++scans;
+        if (accepted) ++accepted_scans;
+    }
+
+    /// @copydoc null_observer::consumed()
+    void consumed(std::size_t pixels) noexcept {
+        consumed_pixels += pixels;
+    }
+
+    /// @copydoc null_observer::merged()
+    void merged() noexcept {
+        ++merges;
+    }
+
+    /// @copydoc null_observer::begin_phase()
+    void begin_phase(phase_t phase) noexcept {
+        (void)phase;
+        _start = std::chrono::steady_clock::now();
+    }
+
+    /// @copydoc null_observer::end_phase()
+    void end_phase(phase_t phase) noexcept {
+        time[static_cast<std::size_t>(phase)] +=
+            std::chrono::steady_clock::now() - _start;
+    }
+
+  private:
+    /// The start of the current phase; phases do not nest.
+    std::chrono::steady_clock::time_point _start;
+};
+
+/**
+ * @brief Vote a pixel, reporting to an observer.
+ *
+ * Accumulators that report the threshold tests provide a @c vote()
+ * member taking an observer; with a @ref null_observer the plain @c
+ * vote() is called instead, so any accumulator can be used when
+ * nothing is observed.
+ *
+ * @param accumulator the accumulator
+ *
+ * @param p the point to register
+ *
+ * @param segment set to the line found, if any
+ *
+ * @param observer the observer
+ *
+ * @return the result of the vote
+ */
+template <class Accumulator, class Observer>
+static inline bool observed_vote(Accumulator &accumulator, point_t const &p,
+                                 segment_t &segment, Observer &observer) {
+    return accumulator.vote(p, segment, observer);
+}
+
+/// @copydoc observed_vote()
+template <class Accumulator>
+static inline bool observed_vote(Accumulator &accumulator, point_t const &p,
+                                 segment_t &segment, null_observer &) {
+    return accumulator.vote(p, segment);
+}
+
+} // namespace ppht
+
+#endif /* ppht_observer_hpp */
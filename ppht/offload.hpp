@@ -0,0 +1,373 @@
+#ifndef ppht_offload_hpp
+#define ppht_offload_hpp
+
+#include <ppht/accumulator.hpp>
+#include <ppht/kernel.hpp>
+#include <ppht/observer.hpp>
+#include <ppht/parameters.hpp>
+#include <ppht/raster.hpp>
+#include <ppht/trig.hpp>
+#include <ppht/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief The reference device of @ref offload_accumulator, running on
+ * the host.
+ *
+ * A device provides the storage of the counter matrix and a kernel
+ * applying an ordered batch of votes or unvotes to it.  An
+ * implementation for an accelerator would keep the matrix in memory
+ * shared with the host (CUDA managed memory or a SYCL USM shared
+ * allocation, say), since the candidates of a significant vote are
+ * read on the host, and would launch one kernel per batch.  This one
+ * runs the batch in a loop and serves as the specification of the
+ * results.
+ *
+ * A device must provide the members of this class.
+ */
+struct host_device {
+    /**
+     * @brief The storage of the counter matrix.
+     *
+     * @tparam T the type of the counters
+     */
+    template <class T>
+    using raster = ppht::raster<T>;
+
+    /**
+     * @brief Apply a batch of votes or unvotes.
+     *
+     * The points are applied in order.  For a batch of votes, @c
+     * n[i] is set to the largest counter incremented by the @c i-th
+     * point, as it was just after that point: what @ref
+     * accumulator::vote() would have seen had the points been voted
+     * one at a time.
+     *
+     * @param trig the trigonometry table of the accumulator
+     *
+     * @param kernel the kernel computing the scaled rho values
+     *
+     * @param counters the counter matrix
+     *
+     * @param points the first of the points
+     *
+     * @param count the number of points
+     *
+     * @param vote true to vote the points, false to unvote them
+     *
+     * @param n the largest count of each vote; unused for unvotes
+     *
+     * @throws std::logic_error if a counter would drop below zero
+     */
+    template <class Kernel, class Matrix, class Count>
+    void apply(trig_table const &trig, Kernel const &kernel, Matrix &counters,
+               point_t const *points, std::size_t count, bool vote,
+               Count *n) const {
+        constexpr std::size_t block_size = 64;
+
+        auto const max_rho = counters.rows();
+        auto const max_theta = counters.cols();
+
+        long scaled[block_size];
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Count m = 0;
+
+            for (std::size_t first = 0; first < max_theta;
+                 first += block_size) {
+                auto const stop = std::min(first + block_size, max_theta);
+
+                kernel(trig, points[i], first, stop, scaled);
+
+                for (auto theta = first; theta < stop; ++theta) {
+                    auto const r = scaled[theta - first];
+                    if (r < 0 || r >= static_cast<long>(max_rho)) continue;
+
+                    auto &&counter = counters[r][theta];
+
+                    if (vote) {
+                        ++counter;
+                        m = std::max<Count>(m, counter);
+                    }
+                    else {
+                        if (counter == 0) throw std::logic_error{"unvote"};
+                        --counter;
+                    }
+                }
+            }
+
+            if (vote) n[i] = m;
+        }
+    }
+};
+
+/**
+ * @brief An accumulator whose counters are updated by a device.
+ *
+ * The counter matrix lives in the storage of the @c Device and is
+ * updated by its kernel, one batch of points per launch; the
+ * threshold test, the clusters of candidates and the segments are
+ * computed on the host as in @ref accumulator.
+ *
+ * Unvotes are queued and applied in one batch before the next vote,
+ * the next @ref reset(), or when @c batch of them are waiting; an
+ * error in one is reported by the call that applies the batch.  The
+ * votes of @ref vote(ForwardIt, ForwardIt, segment_t &, Observer &) are
+ * applied in one batch; the threshold is then re-checked in order
+ * for each point, and the points after the first one to find a line
+ * are withdrawn, so the result is that of voting them one at a time.
+ * @ref vote(point_t const &, segment_t &) costs a launch per point and
+ * keeps the class usable wherever an @c Accumulator is expected, as
+ * in @ref find_segments().
+ *
+ * @tparam Device the device; see @ref host_device
+ *
+ * @tparam Count the type used for the counters
+ *
+ * @tparam Kernel the class used to compute rho values while voting
+ */
+template <class Device = host_device, class Count = std::uint16_t,
+          class Kernel = scalar_kernel>
+class offload_accumulator
+    : public accumulator<Count, Device::template raster, Kernel> {
+    /// The host implementation.
+    using base = accumulator<Count, Device::template raster, Kernel>;
+
+    /// The type of seed for the URBG.
+    using seed_t = std::random_device::result_type;
+
+    /// The device updating the counters.
+    Device _device;
+
+    /// The largest number of unvotes queued.
+    std::size_t _batch;
+
+    /// The points waiting to be unvoted.
+    std::vector<point_t> _unvotes;
+
+    /// The points of the current batch of votes.
+    std::vector<point_t> _points;
+
+    /// The largest count of each vote in the current batch.
+    std::vector<Count> _counts;
+
+    /**
+     * @brief Launch a batch on the device.
+     *
+     * @param points the first of the points
+     *
+     * @param count the number of points
+     *
+     * @param vote true to vote the points, false to unvote them
+     */
+    void launch(point_t const *points, std::size_t count, bool vote) {
+        if (count == 0) return;
+
+        if (vote) _counts.resize(count);
+
+        _device.apply(this->trig(), this->kernel(), this->counters(), points,
+                      count, vote, _counts.data());
+    }
+
+    /// Apply the queued unvotes.
+    void flush() {
+        // Clear the queue first: a batch that throws is not retried.
+
+        _points.swap(_unvotes);
+        _unvotes.clear();
+
+        launch(_points.data(), _points.size(), false);
+
+        for (auto &&p : _points) this->forget(p);
+    }
+
+  public:
+    /**
+     * @brief Construct an instance of @ref offload_accumulator.
+     *
+     * @param rows the height of the bitmap
+     *
+     * @param cols the width of the bitmap
+     *
+     * @param param parameters controlling the operation of the accumulator
+     *
+     * @param seed the seed for the random number generator used to
+     *        break ties.
+     *
+     * @param batch the largest number of unvotes queued before they
+     *        are applied
+     *
+     * @param device the device updating the counters
+     */
+    offload_accumulator(std::size_t rows, std::size_t cols,
+                        parameters const &param,
+                        seed_t seed = std::random_device{}(),
+                        std::size_t batch = 256, Device device = Device{})
+        : base(rows, cols, param, seed)
+        , _device(std::move(device))
+        , _batch(std::max<std::size_t>(batch, 1)) {}
+
+    /**
+     * @brief Get the device.
+     *
+     * @return the device updating the counters
+     */
+    Device &device() noexcept {
+        return _device;
+    }
+
+    /// @copydoc accumulator::reset()
+    void reset() {
+        _unvotes.clear();
+        base::reset();
+    }
+
+    /**
+     * @brief Add all lines passing through the given point to the
+     * accumulator.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     *
+     * @throws std::logic_error if a queued unvote fails
+     *
+     * @see accumulator::vote()
+     */
+    bool vote(point_t const &p, segment_t &segment) {
+        null_observer observer;
+        return vote(p, segment, observer);
+    }
+
+    /**
+     * @brief Vote a point, reporting the threshold test to an
+     * observer.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @param observer the observer; see @ref null_observer
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     *
+     * @throws std::logic_error if a queued unvote fails
+     */
+    template <class Observer>
+    bool vote(point_t const &p, segment_t &segment, Observer &observer) {
+        flush();
+        launch(&p, 1, true);
+
+        this->commit_vote(p);
+        this->locate(p);
+
+        return this->conclude(_counts[0], segment, observer);
+    }
+
+    /**
+     * @brief Vote a batch of points, stopping at the first to find a
+     * line.
+     *
+     * The points are voted in one launch.  If one of them finds a
+     * line, the votes of the points after it are withdrawn in a second
+     * launch; the caller may vote them again later.
+     *
+     * @tparam ForwardIt a forward iterator over @ref point_t
+     *
+     * @param first the first point to vote
+     *
+     * @param last one past the last point to vote
+     *
+     * @param segment set to the line found, if any
+     *
+     * @param observer the observer; see @ref null_observer
+     *
+     * @return the point that found a line, or @c last if none did
+     *
+     * @throws std::logic_error if a queued unvote fails
+     */
+    template <class ForwardIt, class Observer>
+    ForwardIt vote(ForwardIt first, ForwardIt last, segment_t &segment,
+                   Observer &observer) {
+        null_observer quiet;
+
+        flush();
+
+        while (first != last) {
+            _points.assign(first, last);
+            launch(_points.data(), _points.size(), true);
+
+            for (std::size_t i = 0; i < _points.size(); ++i, ++first) {
+                auto const n = _counts[i];
+
+                this->commit_vote(_points[i]);
+
+                if (!this->passes(n, quiet)) {
+                    // Report the test as a single vote would.
+                    this->passes(n, observer);
+                    continue;
+                }
+
+                // Withdraw the votes after this one before looking
+                // for its line.
+
+                launch(_points.data() + i + 1, _points.size() - i - 1, false);
+
+                this->locate(_points[i]);
+
+                if (this->conclude(n, segment, observer)) return first;
+
+                ++first;
+                break;
+            }
+        }
+
+        return last;
+    }
+
+    /**
+     * @brief Vote a batch of points, stopping at the first to find a
+     * line.
+     *
+     * Equivalent to the overload taking an observer, with a @ref
+     * null_observer.
+     */
+    template <class ForwardIt>
+    ForwardIt vote(ForwardIt first, ForwardIt last, segment_t &segment) {
+        null_observer observer;
+        return vote(first, last, segment, observer);
+    }
+
+    /**
+     * @brief Queue a point to be unvoted.
+     *
+     * @param p the point to unregister
+     *
+     * @throws std::logic_error if the batch applied fails
+     */
+    void unvote(point_t const &p) {
+        _unvotes.push_back(p);
+        --this->_votes;
+
+        if (_unvotes.size() >= _batch) flush();
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_offload_hpp */
@@ -0,0 +1,138 @@
+#ifndef ppht_oriented_state_hpp
+#define ppht_oriented_state_hpp
+
+#include <ppht/raster.hpp>
+#include <ppht/state.hpp>
+#include <ppht/types.hpp>
+
+#include <cstddef>
+#include <random>
+
+namespace ppht {
+
+/**
+ * @brief A state that also records the gradient orientation of each
+ * pixel.
+ *
+ * When an edge detector provides the direction of the gradient at
+ * each pixel, only the lines roughly perpendicular to the gradient
+ * need be voted.  @ref find_segments() and the other drivers vote the
+ * pixels of this state with @ref accumulator::vote(point_t const &,
+ * double, double, segment_t &, Observer &), restricting each vote to
+ * the columns within @ref tolerance() of the orientation of the
+ * pixel, and unvote them the same way.
+ *
+ * The accumulator must provide those overloads; @ref accumulator
+ * does, @ref parallel_accumulator and @ref coarse_accumulator do not.
+ *
+ * @tparam Raster the class used for the status of the pixels
+ */
+template <template <class> class Raster = raster>
+class oriented_state : public state<Raster> {
+    /// The class holding the status of the pixels.
+    using base = state<Raster>;
+
+    /// The type of seed for the URBG.
+    using seed_t = std::default_random_engine::result_type;
+
+    /// The orientation of each pixel, in radians.
+    raster<float> _orientation;
+
+    /// The largest difference in angle voted, in radians.
+    double _tolerance;
+
+  public:
+    /**
+     * @brief Create an empty state.
+     *
+     * @param rows the height of the represented image.
+     *
+     * @param cols the width of the represented image.
+     *
+     * @param tolerance the largest difference in angle between the
+     *   orientation of a pixel and the normal of the lines it votes
+     *   for, in radians
+     *
+     * @param seed the seed for the random engine.
+     */
+    oriented_state(std::size_t rows, std::size_t cols, double tolerance,
+                   seed_t seed = std::random_device{}())
+        : base(rows, cols, seed)
+        , _orientation(rows, cols)
+        , _tolerance(tolerance) {}
+
+    /**
+     * @brief Get the tolerance of the votes.
+     *
+     * @return the largest difference in angle voted, in radians
+     */
+    double tolerance() const noexcept {
+        return _tolerance;
+    }
+
+    /**
+     * @brief Get the orientation of a pixel.
+     *
+     * @param point the pixel
+     *
+     * @return the orientation given to @ref mark_pending(), or zero
+     */
+    double orientation(point_t const &point) const {
+        return _orientation[std::get<1>(point)][std::get<0>(point)];
+    }
+
+    /**
+     * @brief Mark a pixel as @c pending.
+     *
+     * @param point the pixel to mark.
+     *
+     * @param orientation the direction of the gradient at the pixel,
+     *   in radians; taken modulo a semiturn
+     */
+    void mark_pending(point_t const &point, double orientation) {
+        _orientation[std::get<1>(point)][std::get<0>(point)] =
+            static_cast<float>(orientation);
+        base::mark_pending(point);
+    }
+};
+
+/**
+ * @brief Vote a pixel of an @ref oriented_state within the tolerance
+ * of its orientation.
+ *
+ * @copydetails vote_pixel()
+ */
+template <template <class> class Raster, class Accumulator, class Observer>
+static inline bool vote_pixel(oriented_state<Raster> &state,
+                              Accumulator &accumulator, point_t const &p,
+                              segment_t &segment, Observer &observer) {
+    return accumulator.vote(p, state.orientation(p), state.tolerance(),
+                            segment, observer);
+}
+
+/**
+ * @brief Withdraw the vote of a pixel of an @ref oriented_state.
+ *
+ * @copydetails unvote_pixel()
+ */
+template <template <class> class Raster, class Accumulator>
+static inline void unvote_pixel(oriented_state<Raster> &state,
+                                Accumulator &accumulator, point_t const &p) {
+    accumulator.unvote(p, state.orientation(p), state.tolerance());
+}
+
+/**
+ * @brief Return a pixel drawn from an @ref oriented_state to the
+ * pending set, keeping its orientation.
+ *
+ * @copydetails restore_pixel()
+ */
+template <template <class> class Raster>
+static inline void restore_pixel(oriented_state<Raster> &state,
+                                 point_t const &p) {
+    state.mark_pending(p, state.orientation(p));
+}
+
+} // namespace ppht
+
+#endif /* ppht_oriented_state_hpp */
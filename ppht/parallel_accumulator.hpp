@@ -0,0 +1,194 @@
+#ifndef ppht_parallel_accumulator_hpp
+#define ppht_parallel_accumulator_hpp
+
+#include <ppht/accumulator.hpp>
+#include <ppht/kernel.hpp>
+#include <ppht/observer.hpp>
+#include <ppht/parameters.hpp>
+#include <ppht/raster.hpp>
+#include <ppht/thread_pool.hpp>
+#include <ppht/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief An accumulator that spreads each vote across threads.
+ *
+ * The columns (theta values) of the counter matrix are divided into
+ * contiguous shards, one per thread of an internal @ref thread_pool.
+ * Every call to @ref vote() or @ref unvote() updates the shards in
+ * parallel; the maxima found in each shard are then combined, so the
+ * result of every vote is identical to that of @ref accumulator.
+ * Used with @ref find_segments() and a fixed seed, the segments found
+ * are the same as with the single-threaded accumulator.
+ *
+ * The oriented overloads of @ref accumulator::vote() and @ref
+ * accumulator::unvote() are inherited unchanged and run on the
+ * calling thread: their window is usually only a few columns wide,
+ * too narrow to be worth dividing.
+ *
+ * Since a vote costs a few microseconds, the fan-out only pays off
+ * for large values of @ref parameters::max_theta or many cores.
+ *
+ * @tparam Count the type used for the counters
+ *
+ * @tparam Raster the type used for the matrix of counters
+ *
+ * @tparam Kernel the class used to compute rho values while voting
+ */
+template <class Count = std::uint16_t,
+          template <class> class Raster = raster,
+          class Kernel = scalar_kernel>
+class parallel_accumulator : public accumulator<Count, Raster, Kernel> {
+    /// The single-threaded implementation.
+    using base = accumulator<Count, Raster, Kernel>;
+
+    /// The type of seed for the URBG.
+    using seed_t = std::random_device::result_type;
+
+    /// The columns of the matrix assigned to a task.
+    struct shard_t {
+        /// The first column of the shard.
+        std::size_t first;
+
+        /// One past the last column of the shard.
+        std::size_t last;
+
+        /// The largest count seen in the shard.
+        Count n;
+    };
+
+    /// The threads performing the updates.
+    thread_pool _pool;
+
+    /// One entry per task.
+    std::vector<shard_t> _shards;
+
+  public:
+    using base::unvote;
+    using base::vote;
+
+    /**
+     * @brief Construct an instance of @ref parallel_accumulator.
+     *
+     * @param rows the height of the bitmap
+     *
+     * @param cols the width of the bitmap
+     *
+     * @param param parameters controlling the operation of the accumulator
+     *
+     * @param seed the seed for the random number generator used to
+     *        break ties.
+     *
+     * @param threads the number of threads to use; zero selects the
+     *        hardware concurrency
+     */
+    parallel_accumulator(std::size_t rows, std::size_t cols,
+                         parameters const &param,
+                         seed_t seed = std::random_device{}(),
+                         std::size_t threads = 0)
+        : base(rows, cols, param, seed)
+        , _pool(threads) {
+        // Keep the shards a multiple of 64 columns wide so that no two
+        // shards write to the same cache line of a row.
+
+        auto const max_theta = base::max_theta();
+        auto const columns = (max_theta + 63) / 64;
+        auto const count = std::min(_pool.size(), columns);
+
+        _shards.resize(count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            _shards[i].first = std::min(columns * i / count * 64, max_theta);
+            _shards[i].last =
+                std::min(columns * (i + 1) / count * 64, max_theta);
+        }
+    }
+
+    /**
+     * @brief Get the number of shards.
+     *
+     * @return the number of tasks each vote is divided into
+     */
+    std::size_t shards() const noexcept {
+        return _shards.size();
+    }
+
+    /**
+     * @brief Add all lines passing through the given point to the
+     * accumulator.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     *
+     * @see accumulator::vote()
+     */
+    bool vote(point_t const &p, segment_t &segment) {
+        null_observer observer;
+        return vote(p, segment, observer);
+    }
+
+    /**
+     * @brief Vote a point, reporting the threshold test to an
+     * observer.
+     *
+     * @param p the point to register
+     *
+     * @param segment set to the intersection of the line found and
+     *   the bounds of the image only if the function returns true
+     *
+     * @param observer the observer; see @ref null_observer
+     *
+     * @return true if the number of votes for the line segment pass
+     *   the threshold
+     */
+    template <class Observer>
+    bool vote(point_t const &p, segment_t &segment, Observer &observer) {
+        _pool.parallel_for(_shards.size(), [&](std::size_t i) {
+            auto &shard = _shards[i];
+            shard.n = 0;
+            this->tally(p, shard.first, shard.last, shard.n);
+        });
+
+        // Reduce the shards to the overall maximum; the candidates
+        // are collected by conclude() only if it is significant.
+
+        Count n = 0;
+
+        for (auto &&shard : _shards) n = std::max(n, shard.n);
+
+        this->commit_vote(p);
+
+        return this->conclude(n, segment, observer);
+    }
+
+    /**
+     * Update the register by undoing a previous call to @ref vote().
+     *
+     * @param p the point to unregister
+     *
+     * @throws std::logic_error if the point was not voted
+     */
+    void unvote(point_t const &p) {
+        _pool.parallel_for(_shards.size(), [&](std::size_t i) {
+            this->untally(p, _shards[i].first, _shards[i].last);
+        });
+
+        this->commit_unvote(p);
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_parallel_accumulator_hpp */
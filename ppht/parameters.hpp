@@ -1,6 +1,8 @@
 #ifndef ppht_parameters_hpp
 #define ppht_parameters_hpp
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 
 namespace ppht {
@@ -72,6 +74,28 @@ struct parameters {
      */
     std::uint16_t min_length = 10;
 
+    /**
+     * @brief The maximum number of pixels to vote.
+     *
+     * The algorithm finds the most significant lines first, so
+     * stopping early mostly loses short or faint segments.  When the
+     * budget is spent the search stops and the segments found so far
+     * are post-processed and returned.  Zero means no limit.
+     *
+     * @sa time_budget
+     */
+    std::size_t max_votes = 0;
+
+    /**
+     * @brief The maximum wall-clock time of a search.
+     *
+     * Measured with @c std::steady_clock from the start of the search
+     * and checked every few votes, so it may be overrun by the time of
+     * a few votes and a channel scan.  As with @ref max_votes, the
+     * segments found so far are returned.  Zero means no limit.
+     */
+    std::chrono::microseconds time_budget{0};
+
     /**
      * @brief Chained constructor operation.
      *
@@ -143,6 +167,171 @@ struct parameters {
         this->min_length = min_length;
         return *this;
     }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param max_votes the new value for @ref max_votes
+     *
+     * @return the parameters object
+     */
+    parameters &set_max_votes(std::size_t max_votes) {
+        this->max_votes = max_votes;
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param time_budget the new value for @ref time_budget
+     *
+     * @return the parameters object
+     */
+    parameters &set_time_budget(std::chrono::microseconds time_budget) {
+        this->time_budget = time_budget;
+        return *this;
+    }
+};
+
+/**
+ * @brief Parameters whose angular resolution and channel width are
+ * fixed at compile time.
+ *
+ * For deployments that use a single configuration.  The values are
+ * held privately: the chained setters of the other parameters return
+ * the @c static_parameters, and those of @ref parameters::max_theta
+ * and @ref parameters::channel_width do not exist, so neither can be
+ * changed once the object is constructed.
+ *
+ * The object converts to <code>parameters const &</code> and may be
+ * passed wherever @ref parameters are expected.  An @ref accumulator,
+ * a @ref detector, and the simplified @ref find_segments() and @ref
+ * for_each_segment() keep its type and share the trigonometry table
+ * of @ref static_trig_table() instead of building their own; the
+ * other entry points see only the converted @ref parameters.
+ *
+ * @tparam MaxTheta the value of @ref parameters::max_theta, in parts
+ *   per semiturn; even, since @ref trig_table fills its second
+ *   quadrant from the first
+ *
+ * @tparam ChannelWidth the value of @ref parameters::channel_width
+ */
+template <std::uint16_t MaxTheta, std::uint16_t ChannelWidth = 3>
+class static_parameters {
+    static_assert(MaxTheta > 0 && MaxTheta % 2 == 0,
+                  "max_theta must be positive and even");
+
+    /// The values of all of the parameters.
+    parameters _param;
+
+  public:
+    /// The number of parts per semiturn.
+    static constexpr std::uint16_t max_theta_value = MaxTheta;
+
+    /// The width of the scan channel.
+    static constexpr std::uint16_t channel_width_value = ChannelWidth;
+
+    /**
+     * @brief Construct the parameters.
+     *
+     * @param param the values of the other parameters; its @ref
+     *   parameters::max_theta and @ref parameters::channel_width are
+     *   replaced
+     */
+    explicit static_parameters(parameters const &param = parameters{})
+        : _param(param) {
+        _param.max_theta = MaxTheta;
+        _param.channel_width = ChannelWidth;
+    }
+
+    /**
+     * @brief Get the values of the parameters.
+     *
+     * @return the parameters, with the fixed resolution and width
+     */
+    parameters const &values() const noexcept {
+        return _param;
+    }
+
+    /// @copydoc values()
+    operator parameters const &() const noexcept {
+        return _param;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param min_trigger_points the new value for @ref
+     *   parameters::min_trigger_points
+     *
+     * @return the parameters object
+     */
+    static_parameters &set_min_trigger_points(
+        std::uint16_t min_trigger_points) {
+        _param.set_min_trigger_points(min_trigger_points);
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param threshold the new value for @ref parameters::threshold
+     *
+     * @return the parameters object
+     */
+    static_parameters &set_threshold(double threshold) {
+        _param.set_threshold(threshold);
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param max_gap the new value for @ref parameters::max_gap
+     *
+     * @return the parameters object
+     */
+    static_parameters &set_max_gap(std::uint16_t max_gap) {
+        _param.set_max_gap(max_gap);
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param min_length the new value for @ref parameters::min_length
+     *
+     * @return the parameters object
+     */
+    static_parameters &set_min_length(std::uint16_t min_length) {
+        _param.set_min_length(min_length);
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param max_votes the new value for @ref parameters::max_votes
+     *
+     * @return the parameters object
+     */
+    static_parameters &set_max_votes(std::size_t max_votes) {
+        _param.set_max_votes(max_votes);
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param time_budget the new value for @ref parameters::time_budget
+     *
+     * @return the parameters object
+     */
+    static_parameters &
+    set_time_budget(std::chrono::microseconds time_budget) {
+        _param.set_time_budget(time_budget);
+        return *this;
+    }
 };
 
 } // namespace ppht
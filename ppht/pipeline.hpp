@@ -0,0 +1,300 @@
+#ifndef ppht_pipeline_hpp
+#define ppht_pipeline_hpp
+
+#include <ppht.hpp>
+#include <ppht/thread_pool.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief A driver that overlaps channel scans with voting.
+ *
+ * In @ref for_each_segment() every vote that triggers a scan stalls
+ * the voting until the scan is done and its pixels are removed.  The
+ * pipeline instead draws the next @ref lag() pixels from the state
+ * first, then scans the channel on one thread while voting those
+ * pixels on another.  The scan only reads the state and the votes
+ * only touch the accumulator, so the two never share data.  When both
+ * are done the segment is committed: its pixels are marked @c done
+ * and those voted, including any of the pixels just drawn, are
+ * unvoted.
+ *
+ * Scans triggered while voting a window are queued and committed in
+ * the order in which they were triggered, each against the state left
+ * by the commits before it.  A queued scan whose triggering pixel has
+ * been consumed by an earlier commit conflicts with it and is
+ * dropped.
+ *
+ * Only one channel is scanned at a time, overlapping the votes of one
+ * window, so the pipeline uses at most two threads.  The result is
+ * deterministic for a given seed and lag, whatever the number of
+ * threads.  With a lag of zero it is the same as that of
+ * @ref for_each_segment(); with a larger lag a few pixels are voted
+ * that the sequential algorithm would have removed first, so the
+ * segments found may differ slightly.
+ *
+ * When a budget in @ref parameters is spent, no more pixels are drawn
+ * but the scans already triggered are still committed.
+ *
+ * The observer, if any, is called from the voting thread during a
+ * window and from the calling thread otherwise, never from both at
+ * once.  The scanning phase it times covers only the commits.
+ *
+ * The overlap only pays with a second core.  On one core the
+ * benchmark finds the pipeline no faster than @ref find_segments()
+ * on images of a million pixels or more, and up to twice as slow on
+ * small ones, where handing each window to the pool costs more than
+ * the scan it hides.
+ */
+class scan_pipeline {
+    /// A triggered scan: the channel and the pixel that triggered it.
+    using trigger_t = std::pair<segment_t, point_t>;
+
+    /// The threads running the scans and the votes.
+    thread_pool _pool;
+
+    /// The number of pixels voted while a channel is scanned.
+    std::size_t _lag;
+
+    /// The scans waiting to be committed, in order, from @ref _head;
+    /// a vector reused from run to run rather than a deque, which
+    /// allocates a block every few scans.
+    std::vector<trigger_t> _triggers;
+
+    /// The index of the next scan to commit.
+    std::size_t _head = 0;
+
+    /// The pixels drawn for the current window.
+    std::vector<point_t> _window;
+
+    /// The scans triggered while voting the current window.
+    std::vector<trigger_t> _window_triggers;
+
+  public:
+    /**
+     * @brief Create a pipeline.
+     *
+     * @param lag the number of pixels voted while a channel is
+     *   scanned
+     *
+     * @param threads one to run the stages in turn on the calling
+     *   thread; any other value overlaps them on two threads
+     */
+    explicit scan_pipeline(std::size_t lag = 8, std::size_t threads = 2)
+        : _pool(threads == 1 ? 1 : 2)
+        , _lag(lag) {
+        // A window triggers at most one scan per pixel.
+
+        _window.reserve(lag);
+        _window_triggers.reserve(lag);
+        _triggers.reserve(2 * lag + 1);
+    }
+
+    /**
+     * @brief Get the number of threads of the pipeline.
+     *
+     * @return one or two
+     */
+    std::size_t threads() const noexcept {
+        return _pool.size();
+    }
+
+    /**
+     * @brief Get the lag of the pipeline.
+     *
+     * @return the number of pixels voted while a channel is scanned
+     */
+    std::size_t lag() const noexcept {
+        return _lag;
+    }
+
+    /**
+     * @brief Run the PPHT algorithm, passing each segment to a
+     * function as soon as it is committed.
+     *
+     * The arguments are those of @ref ppht::for_each_segment().
+     *
+     * @return false if @c emit or the budget stopped the search, true
+     *   if every pixel was processed
+     */
+    template <class State, class Accumulator, class Callback,
+              class Observer>
+    bool for_each_segment(State &state, Accumulator &accumulator,
+                          const parameters &param, scan_buffer &buffer,
+                          Callback &&emit, Observer &observer) {
+        const auto min_length_squared = param.min_length * param.min_length;
+        const auto channel_radius = param.channel_width >> 1;
+
+        vote_budget budget{param};
+        bool spent = false;
+
+        auto const draw = [&](point_t &point) {
+            if (spent || !state.next(point)) return false;
+            if (budget.take()) return true;
+
+            restore_pixel(state, point);
+            spent = true;
+            return false;
+        };
+
+        auto const vote = [&](point_t const &point, auto &triggers) {
+            segment_t scan_channel;
+
+            observer.begin_phase(phase_t::voting);
+            observer.voted();
+
+            auto const triggered =
+                vote_pixel(state, accumulator, point, scan_channel, observer);
+
+            observer.end_phase(phase_t::voting);
+
+            if (triggered) triggers.emplace_back(scan_channel, point);
+        };
+
+        _triggers.clear();
+        _head = 0;
+
+        for (;;) {
+            if (_head == _triggers.size()) {
+                _triggers.clear();
+                _head = 0;
+
+                point_t point;
+
+                if (!draw(point)) break;
+
+                vote(point, _triggers);
+                continue;
+            }
+
+            auto const trigger = _triggers[_head++];
+
+            if (state.status(trigger.second) != status_t::voted) continue;
+
+            // Draw the window before forking: from here until the
+            // join, the state is only read.
+
+            _window.clear();
+
+            point_t point;
+
+            while (_window.size() < _lag && draw(point)) {
+                _window.push_back(point);
+            }
+
+            _window_triggers.clear();
+
+            point_set const *found = nullptr;
+
+            _pool.parallel_for(2, [&](std::size_t task) {
+                if (task == 0) {
+                    found = &scan(state, trigger.first, channel_radius,
+                                  param.max_gap, buffer);
+                }
+                else {
+                    for (auto &&p : _window) vote(p, _window_triggers);
+                }
+            });
+
+            // Drop the committed scans before the vector grows.
+
+            if (_head > _triggers.size() / 2) {
+                _triggers.erase(_triggers.begin(), _triggers.begin() + _head);
+                _head = 0;
+            }
+
+            _triggers.insert(_triggers.end(), _window_triggers.begin(),
+                             _window_triggers.end());
+
+            observer.begin_phase(phase_t::scanning);
+
+            auto const accepted =
+                found->length_squared() >= min_length_squared;
+
+            observer.scanned(accepted);
+
+            if (accepted) {
+                consume_segment(state, accumulator, *found, observer);
+            }
+
+            observer.end_phase(phase_t::scanning);
+
+            if (accepted && !emit(found->segment())) return false;
+        }
+
+        return !spent;
+    }
+
+    /**
+     * @brief Run the PPHT algorithm, passing each segment to a
+     * function as soon as it is committed.
+     *
+     * Equivalent to the overload taking an observer, with a @ref
+     * null_observer.
+     *
+     * @return false if @c emit or the budget stopped the search, true
+     *   if every pixel was processed
+     */
+    template <class State, class Accumulator, class Callback>
+    bool for_each_segment(State &state, Accumulator &accumulator,
+                          const parameters &param, scan_buffer &buffer,
+                          Callback &&emit) {
+        null_observer observer;
+        return for_each_segment(state, accumulator, param, buffer,
+                                std::forward<Callback>(emit), observer);
+    }
+
+    /**
+     * @brief Run the PPHT algorithm and collect the segments.
+     *
+     * The arguments are those of @ref ppht::find_segments(); the
+     * segments appended are post-processed.
+     */
+    template <class State, class Accumulator, class Allocator,
+              class Observer>
+    void find_segments(State &state, Accumulator &accumulator,
+                       const parameters &param,
+                       std::vector<segment_t, Allocator> &segments,
+                       scan_buffer &buffer, Observer &observer) {
+        const auto first = segments.size();
+
+        for_each_segment(state, accumulator, param, buffer,
+                         [&](segment_t const &segment) {
+                             segments.push_back(segment);
+                             return true;
+                         },
+                         observer);
+
+        observer.begin_phase(phase_t::postprocessing);
+
+        segments.erase(postprocess(segments.begin() + first, segments.end(),
+                                   param.channel_width >> 1, observer,
+                                   segments.get_allocator()),
+                       segments.end());
+
+        observer.end_phase(phase_t::postprocessing);
+    }
+
+    /**
+     * @brief Run the PPHT algorithm and collect the segments.
+     *
+     * Equivalent to the overload taking an observer, with a @ref
+     * null_observer.
+     */
+    template <class State, class Accumulator, class Allocator>
+    void find_segments(State &state, Accumulator &accumulator,
+                       const parameters &param,
+                       std::vector<segment_t, Allocator> &segments,
+                       scan_buffer &buffer) {
+        null_observer observer;
+        find_segments(state, accumulator, param, segments, buffer, observer);
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_pipeline_hpp */
@@ -3,7 +3,8 @@
 
 #include <ppht/types.hpp>
 
-#include <set>
+#include <algorithm>
+#include <vector>
 
 namespace ppht {
 
@@ -13,10 +14,15 @@ namespace ppht {
  * The point_set represents a line segment and the image pixels that
  * make up the segment.  The segment need not pass through all of the
  * points and may consist of points not in the pixel set.
+ *
+ * The points are kept in a sorted vector without duplicates.  Points
+ * arriving in increasing order, as they do from @ref scan(), are
+ * appended in constant time; @ref clear() keeps the storage so the
+ * object can be reused without allocating.
  */
 class point_set {
-    /// @brief The points added to the set.
-    std::set<point_t> _points;
+    /// @brief The points added to the set, sorted and unique.
+    std::vector<point_t> _points;
 
     /// @brief The segment making up the canonical points of the set.
     segment_t _segment;
@@ -31,6 +37,15 @@ public:
         return _points.empty();
     }
 
+    /**
+     * @brief Remove all points from the set.
+     *
+     * The storage of the set is retained.
+     */
+    void clear() {
+        _points.clear();
+    }
+
     /**
      * @brief Add a collection of points and their canonical
      * representation to the point set.
@@ -50,7 +65,15 @@ public:
         _segment.second = canonical;
 
         for (auto &&p : points) {
-            _points.insert(p);
+            if (_points.empty() || _points.back() < p) {
+                _points.push_back(p);
+                continue;
+            }
+
+            auto const iter =
+                std::lower_bound(_points.begin(), _points.end(), p);
+
+            if (*iter != p) _points.insert(iter, p);
         }
     }
 
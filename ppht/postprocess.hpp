@@ -2,14 +2,35 @@
 #define ppht_postprocess_hpp
 
 #include <ppht/kd-search.hpp>
+#include <ppht/observer.hpp>
 #include <ppht/types.hpp>
 
-#include <cassert>
-#include <queue>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace ppht {
 
+/**
+ * @brief Find the elements of a range within a disc.
+ *
+ * A convenience wrapper around @ref kd_search() collecting the
+ * elements found.  @ref postprocess() no longer uses it; it queries
+ * an @ref endpoint_grid instead.
+ *
+ * @note The elements of the range are shuffled by the search.
+ *
+ * @param begin the start of the sequence to search
+ * @param end the end of the sequence to search
+ * @param p the center of the disc
+ * @param limit the radius of the disc
+ * @return the elements within the disc
+ */
 template <class RandomIt>
 static inline auto find_nearest(RandomIt begin, RandomIt end,
                                 const point_t &p, unsigned limit) {
@@ -37,38 +58,252 @@ static inline auto distance_to_line_squared(const point_t &pnt1,
     };
 }
 
-template <class ForwardIt>
-ForwardIt postprocess(ForwardIt begin, ForwardIt end, unsigned limit) {
-    using namespace std;
+/**
+ * @brief A uniform grid over the endpoints of a list of segments.
+ *
+ * The endpoints are bucketed into square cells whose side is the
+ * search radius, and the buckets are kept in a single array sorted by
+ * cell, so a radius query visits at most nine cells.  The grid is
+ * built once; segments are removed by flag rather than by rebuilding
+ * it.
+ *
+ * The positions are recorded when the grid is built.  @ref
+ * postprocess() only moves the endpoints of a segment once it is no
+ * longer a candidate for any later query, so the grid stays valid for
+ * the whole pass.
+ *
+ * @tparam Allocator the allocator of the storage of the grid,
+ *   rebound to the types stored
+ */
+template <class Allocator = std::allocator<char>>
+class endpoint_grid {
+    /// An endpoint in the grid.
+    struct entry {
+        /// The cell containing the endpoint.
+        std::uint64_t cell;
 
-    const auto limit_squared = limit * limit;
+        /// The index of the segment.
+        std::size_t index;
+
+        /// The index of the endpoint within the segment (0 or 1).
+        unsigned end;
+
+        /// The position of the endpoint.
+        point_t point;
+    };
+
+    /// The allocator of an element type.
+    template <class T>
+    using allocator_t =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
 
-    for (auto i = begin; i != end; ++i) {
-        point_t &a = i->first;
-        point_t &b = i->second;
+    /// The side of a cell.
+    long _size;
 
-        using tuple_t = tuple<reference_wrapper<point_t>, reference_wrapper<point_t>, ForwardIt>;
+    /// The endpoints, sorted by cell.
+    std::vector<entry, allocator_t<entry>> _entries;
 
-        vector<tuple_t> pool;
+    /// Whether each segment has been removed.
+    std::vector<bool, allocator_t<bool>> _erased;
 
-        for (auto j = i + 1; j != end; ++j) {
-            point_t &c = j->first;
-            point_t &d = j->second;
+    /**
+     * @brief Get the coordinate of the cell containing a coordinate.
+     *
+     * @param v the coordinate of a point
+     *
+     * @return the coordinate of the cell, rounded towards negative
+     *   infinity
+     */
+    long cell_of(long v) const noexcept {
+        return v >= 0 ? v / _size : -((-v - 1) / _size) - 1;
+    }
+
+    /**
+     * @brief Get the key of a cell.
+     *
+     * @param cx the column of the cell
+     *
+     * @param cy the row of the cell
+     *
+     * @return a key unique to the cell
+     */
+    static std::uint64_t key(long cx, long cy) noexcept {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cy))
+                << 32) |
+               static_cast<std::uint32_t>(cx);
+    }
 
-            pool.emplace_back(c, d, j);
-            pool.emplace_back(d, c, j);
+  public:
+    /**
+     * @brief Build a grid over a range of segments.
+     *
+     * @tparam RandomIt the type of iterator over the segments
+     *
+     * @param begin the first segment
+     *
+     * @param end one past the last segment
+     *
+     * @param limit the search radius
+     *
+     * @param alloc the allocator of the storage of the grid
+     */
+    template <class RandomIt>
+    endpoint_grid(RandomIt begin, RandomIt end, unsigned limit,
+                  Allocator const &alloc = Allocator{})
+        : _size(std::max(limit, 1U))
+        , _entries(alloc)
+        , _erased(std::distance(begin, end), false, alloc) {
+        _entries.reserve(2 * _erased.size());
+
+        for (std::size_t i = 0; i < _erased.size(); ++i) {
+            point_t const &a = begin[i].first;
+            point_t const &b = begin[i].second;
+
+            _entries.push_back({key(cell_of(a[0]), cell_of(a[1])), i, 0, a});
+            _entries.push_back({key(cell_of(b[0]), cell_of(b[1])), i, 1, b});
         }
 
-        auto bp = pool.begin();
-        auto ep = pool.end();
+        // Within a cell the entries stay in segment order, so queries
+        // are deterministic.  The order is total, so an unstable sort
+        // (needing no temporary buffer) gives the same result as a
+        // stable sort by cell.
+
+        std::sort(_entries.begin(), _entries.end(),
+                  [](entry const &x, entry const &y) {
+                      return std::tie(x.cell, x.index, x.end) <
+                             std::tie(y.cell, y.index, y.end);
+                  });
+    }
+
+    /**
+     * @brief Remove a segment from the grid.
+     *
+     * @param index the index of the segment
+     */
+    void erase(std::size_t index) {
+        _erased[index] = true;
+    }
+
+    /**
+     * @brief Test whether a segment has been removed.
+     *
+     * @param index the index of the segment
+     *
+     * @return true if @ref erase() has been called for the segment
+     */
+    bool erased(std::size_t index) const {
+        return _erased[index];
+    }
+
+    /**
+     * @brief Find the endpoints within a disc.
+     *
+     * Only endpoints of segments after @c first that have not been
+     * removed are reported, in order of segment index.
+     *
+     * @param p the center of the disc
+     *
+     * @param limit the radius of the disc
+     *
+     * @param first the index of the segment querying the grid
+     *
+     * @param result a vector of the (segment, endpoint) pairs found;
+     *   cleared first
+     */
+    template <class Vector>
+    void find(point_t const &p, long limit, std::size_t first,
+              Vector &result) const {
+        result.clear();
+
+        auto const cx = cell_of(p[0]);
+        auto const cy = cell_of(p[1]);
+
+        auto const by_cell = [](entry const &x, std::uint64_t k) {
+            return x.cell < k;
+        };
+
+        for (long y = cy - 1; y <= cy + 1; ++y) {
+            for (long x = cx - 1; x <= cx + 1; ++x) {
+                auto const k = key(x, y);
+                auto i = std::lower_bound(_entries.begin(), _entries.end(),
+                                          k, by_cell);
+
+                for (; i != _entries.end() && i->cell == k; ++i) {
+                    if (i->index <= first || _erased[i->index]) continue;
+                    if ((p - i->point).length_squared() > limit * limit) {
+                        continue;
+                    }
+
+                    result.emplace_back(i->index, i->end);
+                }
+            }
+        }
+
+        std::sort(result.begin(), result.end());
+    }
+};
+
+/**
+ * @brief Merge colinear segments whose ends meet.
+ *
+ * For each segment in turn, a later segment is merged into it when
+ * one of its endpoints lies within @c limit of an end of the current
+ * segment, and both of its points lie within @c limit of the line
+ * through the far ends of the two.  Each end is extended as far as
+ * possible before moving on.
+ *
+ * The endpoints are indexed once in an @ref endpoint_grid, so the cost
+ * is roughly linear in the number of segments.  The segments are
+ * updated in place; the merged ones are removed and the remaining ones
+ * keep their relative order.
+ *
+ * @tparam RandomIt the type of iterator over the segments
+ *
+ * @param begin the first segment
+ *
+ * @param end one past the last segment
+ *
+ * @param limit the distance within which segments are merged
+ *
+ * @param observer told of every merge; see @ref null_observer
+ *
+ * @param alloc the allocator of the scratch storage, such as an @ref
+ *   arena_allocator; rebound to the types stored
+ *
+ * @return the end of the range of remaining segments
+ */
+template <class RandomIt, class Observer, class Allocator>
+RandomIt postprocess(RandomIt begin, RandomIt end, unsigned limit,
+                     Observer &observer, Allocator const &alloc) {
+    using namespace std;
+
+    using neighbor_t = pair<size_t, unsigned>;
+    using neighbor_allocator_t = typename allocator_traits<
+        Allocator>::template rebind_alloc<neighbor_t>;
+
+    const auto limit_squared = limit * limit;
+    const size_t count = distance(begin, end);
+
+    endpoint_grid<Allocator> grid{begin, end, limit, alloc};
+
+    vector<neighbor_t, neighbor_allocator_t> neighbors{
+        neighbor_allocator_t(alloc)};
+
+    for (size_t i = 0; i < count; ++i) {
+        if (grid.erased(i)) continue;
+
+        point_t &a = begin[i].first;
+        point_t &b = begin[i].second;
 
         for (auto pass = 1; pass <= 2; ++pass) {
         restart:
-            auto neighbors = find_nearest(bp, ep, b, limit);
+            grid.find(b, limit, i, neighbors);
 
             for (auto &&neighbor : neighbors) {
-                point_t &c = get<0>(neighbor);
-                point_t &d = get<1>(neighbor);
+                auto const &other = begin[neighbor.first];
+
+                point_t const &c = neighbor.second ? other.second : other.first;
+                point_t const &d = neighbor.second ? other.first : other.second;
 
                 // The order of the points along the new segment will
                 // be a - b ~ c - d
@@ -82,13 +317,8 @@ ForwardIt postprocess(ForwardIt begin, ForwardIt end, unsigned limit) {
                 // ‖b - c‖ < limit
 
                 b = d;
-                std::iter_swap(get<2>(neighbor), --end);
-
-                auto past_end = [&] (auto &&t) -> bool {
-                    return get<2>(t) == end;
-                };
-
-                ep = std::remove_if(bp, ep, past_end);
+                grid.erase(neighbor.first);
+                observer.merged();
 
                 goto restart;
             }
@@ -97,7 +327,58 @@ ForwardIt postprocess(ForwardIt begin, ForwardIt end, unsigned limit) {
         }
     }
 
-    return end;
+    auto out = begin;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (grid.erased(i)) continue;
+        if (out != begin + i) *out = std::move(begin[i]);
+        ++out;
+    }
+
+    return out;
+}
+
+/**
+ * @brief Merge colinear segments whose ends meet.
+ *
+ * Equivalent to the overload taking an allocator, allocating from
+ * the heap.
+ *
+ * @tparam RandomIt the type of iterator over the segments
+ *
+ * @param begin the first segment
+ *
+ * @param end one past the last segment
+ *
+ * @param limit the distance within which segments are merged
+ *
+ * @param observer told of every merge; see @ref null_observer
+ *
+ * @return the end of the range of remaining segments
+ */
+template <class RandomIt, class Observer>
+RandomIt postprocess(RandomIt begin, RandomIt end, unsigned limit,
+                     Observer &observer) {
+    return postprocess(begin, end, limit, observer, std::allocator<char>{});
+}
+
+/**
+ * @brief Merge colinear segments whose ends meet.
+ *
+ * @tparam RandomIt the type of iterator over the segments
+ *
+ * @param begin the first segment
+ *
+ * @param end one past the last segment
+ *
+ * @param limit the distance within which segments are merged
+ *
+ * @return the end of the range of remaining segments
+ */
+template <class RandomIt>
+RandomIt postprocess(RandomIt begin, RandomIt end, unsigned limit) {
+    null_observer observer;
+    return postprocess(begin, end, limit, observer);
 }
 
 }
@@ -1,6 +1,8 @@
 #ifndef ppht_raster_hpp
 #define ppht_raster_hpp
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 namespace ppht {
@@ -89,6 +91,433 @@ class raster {
     }
 };
 
+/**
+ * @brief A 2D array of elements stored in rectangular tiles.
+ *
+ * The raster is divided into tiles of @c TileRows by @c TileCols
+ * elements.  Each tile is contiguous in memory (row-major within the
+ * tile) and the tiles themselves are laid out row-major.  Compared to
+ * @ref raster this keeps cells that are close in both dimensions
+ * close in memory: moving down one row inside a tile moves @c
+ * TileCols elements instead of a full raster row.
+ *
+ * The accumulator benefits from this because a vote touches one cell
+ * per column and consecutive columns differ by only a few rows, so a
+ * vote's writes stay within a small number of pages.
+ *
+ * The interface is the same as that of @ref raster except that
+ * operator[] returns a proxy for the row rather than a pointer.
+ * Does not perform bounds checking.
+ *
+ * @tparam T the type of elements to store
+ *
+ * @tparam TileRows the height of a tile; must be a power of two
+ *
+ * @tparam TileCols the width of a tile; must be a power of two
+ *
+ * @sa tiled_raster
+ */
+template <class T, std::size_t TileRows, std::size_t TileCols>
+class basic_tiled_raster {
+    static_assert(TileRows && !(TileRows & (TileRows - 1)),
+                  "TileRows must be a power of two");
+    static_assert(TileCols && !(TileCols & (TileCols - 1)),
+                  "TileCols must be a power of two");
+
+    /// The number of elements in a tile.
+    static constexpr std::size_t tile_size = TileRows * TileCols;
+
+    /// The elements of the raster.
+    std::unique_ptr<T[]> _data;
+
+    /// The height of this raster.
+    std::size_t const _rows;
+
+    /// The width of this raster.
+    std::size_t const _cols;
+
+    /// The number of elements in a horizontal band of tiles.
+    std::size_t const _band_size;
+
+    /**
+     * @brief Round a dimension up to a multiple of the tile size.
+     *
+     * @param n the dimension
+     *
+     * @param tile the tile dimension
+     *
+     * @return the rounded value
+     */
+    static constexpr std::size_t round_up(std::size_t n,
+                                          std::size_t tile) noexcept {
+        return (n + tile - 1) / tile * tile;
+    }
+
+  public:
+    /// The type of the cells of this raster.
+    using value_type = T;
+
+    /**
+     * @brief A proxy for a row of the raster.
+     *
+     * @tparam U the (possibly const-qualified) element type
+     */
+    template <class U>
+    class row_proxy {
+        /// The first element of the row in the first tile.
+        U *_base;
+
+      public:
+        /**
+         * @brief Construct a row proxy.
+         *
+         * @param base the first element of the row in the first tile
+         */
+        explicit row_proxy(U *base) noexcept
+            : _base(base) {}
+
+        /**
+         * @brief Access the specified column of the row.
+         *
+         * @param col the column number
+         *
+         * @return a reference to the element
+         */
+        U &operator[](std::size_t col) const noexcept {
+            return _base[(col / TileCols) * tile_size + (col % TileCols)];
+        }
+    };
+
+    /**
+     * @brief Create a new raster with the given size.
+     *
+     * @param rows the number of rows (height) of the raster.
+     *
+     * @param cols the number of columns (width) of the raster.
+     */
+    basic_tiled_raster(std::size_t rows, std::size_t cols)
+        : _data(new T[round_up(rows, TileRows) * round_up(cols, TileCols)]{})
+        , _rows(rows)
+        , _cols(cols)
+        , _band_size(round_up(cols, TileCols) * TileRows) {}
+
+    /**
+     * @brief Get the height of the raster.
+     *
+     * @return the number of rows in the raster
+     */
+    std::size_t const &rows() const {
+        return _rows;
+    }
+
+    /**
+     * @brief Get the width of the raster.
+     *
+     * @return the number of columns in the raster
+     */
+    std::size_t const &cols() const {
+        return _cols;
+    }
+
+    /**
+     * @brief Access the specified row of the raster.
+     *
+     * This method does not do bounds checking.
+     *
+     * @param row the row number
+     *
+     * @return a proxy for the row
+     */
+    row_proxy<T> operator[](std::size_t row) {
+        return row_proxy<T>{_data.get() + (row / TileRows) * _band_size +
+                            (row % TileRows) * TileCols};
+    }
+
+    /**
+     * @brief Access the specified row of the raster as a read-only
+     * array.
+     *
+     * This method does not do bounds checking.
+     *
+     * @param row the row number
+     *
+     * @return a proxy for the row
+     */
+    row_proxy<T const> operator[](std::size_t row) const {
+        return row_proxy<T const>{_data.get() + (row / TileRows) * _band_size +
+                                  (row % TileRows) * TileCols};
+    }
+};
+
+/**
+ * @brief A tiled raster with tiles suited to the accumulator.
+ *
+ * Tiles are 8 rows by 32 columns; for the default 16-bit counters a
+ * tile row is half a cache line and a whole tile is 512 bytes.  This
+ * alias can be passed wherever a <code>template &lt;class&gt;
+ * class Raster</code> parameter is expected.
+ *
+ * @tparam T the type of elements to store
+ */
+template <class T>
+using tiled_raster = basic_tiled_raster<T, 8, 32>;
+
+/**
+ * @brief A 2D array of two-bit elements.
+ *
+ * Each element is stored in two bits of a 64-bit word, so a word
+ * holds @ref cells_per_word consecutive elements of a row.  Every row
+ * starts on a word boundary and @ref row_proxy::words() gives access
+ * to the words of a row, so a caller can test many cells with one
+ * load.  This is meant for the @ref state raster: @ref status_t has
+ * four values, and packing them takes one sixteenth of the memory of
+ * an enum per pixel.
+ *
+ * The interface is the same as that of @ref raster except that
+ * operator[] returns a proxy for the row, whose operator[] returns a
+ * proxy @ref reference for a mutable raster and a value for a const
+ * one.  Does not perform bounds checking.
+ *
+ * @tparam T the type of elements to store; must be convertible to
+ *   and from the integers 0 through 3
+ */
+template <class T>
+class packed_raster {
+  public:
+    /// The type of the storage words.
+    using word_type = std::uint64_t;
+
+    /// The number of bits per element.
+    static constexpr unsigned bits_per_cell = 2;
+
+    /// The number of elements per storage word.
+    static constexpr std::size_t cells_per_word =
+        sizeof(word_type) * 8 / bits_per_cell;
+
+    /// The type of the cells of this raster.
+    using value_type = T;
+
+  private:
+    /// The mask of the bits of an element in the low end of a word.
+    static constexpr word_type cell_mask = (word_type{1} << bits_per_cell) - 1;
+
+    /// The words of the raster.
+    std::unique_ptr<word_type[]> _data;
+
+    /// The height of this raster.
+    std::size_t const _rows;
+
+    /// The width of this raster.
+    std::size_t const _cols;
+
+    /// The number of words in a row.
+    std::size_t const _stride;
+
+  public:
+    /**
+     * @brief A proxy for an element of a mutable raster.
+     */
+    class reference {
+        /// The word holding the element.
+        word_type *_word;
+
+        /// The position of the element in the word.
+        unsigned _shift;
+
+      public:
+        /**
+         * @brief Construct a reference.
+         *
+         * @param word the word holding the element
+         *
+         * @param shift the position of the element in the word
+         */
+        reference(word_type *word, unsigned shift) noexcept
+            : _word(word)
+            , _shift(shift) {}
+
+        /**
+         * @brief Read the element.
+         *
+         * @return the value of the element
+         */
+        operator T() const noexcept {
+            return static_cast<T>((*_word >> _shift) & cell_mask);
+        }
+
+        /**
+         * @brief Write the element.
+         *
+         * @param value the new value of the element
+         *
+         * @return the reference
+         */
+        reference &operator=(T value) noexcept {
+            auto const bits = static_cast<word_type>(value) & cell_mask;
+            *_word = (*_word & ~(cell_mask << _shift)) | (bits << _shift);
+            return *this;
+        }
+
+        /**
+         * @brief Copy the value of another element.
+         *
+         * @param r the element to copy
+         *
+         * @return the reference
+         */
+        reference &operator=(reference const &r) noexcept {
+            return *this = static_cast<T>(r);
+        }
+    };
+
+    /**
+     * @brief A proxy for a row of the raster.
+     *
+     * @tparam Word the (possibly const-qualified) word type
+     */
+    template <class Word>
+    class row_proxy {
+        /// The first word of the row.
+        Word *_words;
+
+      public:
+        /**
+         * @brief Construct a row proxy.
+         *
+         * @param words the first word of the row
+         */
+        explicit row_proxy(Word *words) noexcept
+            : _words(words) {}
+
+        /**
+         * @brief Access the specified column of the row.
+         *
+         * @param col the column number
+         *
+         * @return a @ref reference to the element, or its value if
+         *   the raster is const
+         */
+        auto operator[](std::size_t col) const noexcept {
+            return get(_words, col);
+        }
+
+        /**
+         * @brief Access the words of the row.
+         *
+         * Element @c col is in bits <code>2 * (col % cells_per_word)
+         * </code> and up of word <code>col / cells_per_word</code>.
+         * The unused bits of the last word are zero.
+         *
+         * @return a pointer to the first word of the row
+         */
+        Word *words() const noexcept {
+            return _words;
+        }
+    };
+
+  private:
+    /**
+     * @brief Get a writable element.
+     *
+     * @param words the first word of the row
+     *
+     * @param col the column number
+     *
+     * @return a reference to the element
+     */
+    static reference get(word_type *words, std::size_t col) noexcept {
+        return reference{words + col / cells_per_word,
+                         static_cast<unsigned>(col % cells_per_word) *
+                             bits_per_cell};
+    }
+
+    /**
+     * @brief Get the value of an element.
+     *
+     * @param words the first word of the row
+     *
+     * @param col the column number
+     *
+     * @return the value of the element
+     */
+    static T get(word_type const *words, std::size_t col) noexcept {
+        auto const shift = (col % cells_per_word) * bits_per_cell;
+        return static_cast<T>((words[col / cells_per_word] >> shift) &
+                              cell_mask);
+    }
+
+  public:
+    /**
+     * @brief Create a new raster with the given size.
+     *
+     * All elements are initialized to zero.
+     *
+     * @param rows the number of rows (height) of the raster.
+     *
+     * @param cols the number of columns (width) of the raster.
+     */
+    packed_raster(std::size_t rows, std::size_t cols)
+        : _data(new word_type[rows *
+                              ((cols + cells_per_word - 1) / cells_per_word)]{})
+        , _rows(rows)
+        , _cols(cols)
+        , _stride((cols + cells_per_word - 1) / cells_per_word) {}
+
+    /**
+     * @brief Get the height of the raster.
+     *
+     * @return the number of rows in the raster
+     */
+    std::size_t const &rows() const {
+        return _rows;
+    }
+
+    /**
+     * @brief Get the width of the raster.
+     *
+     * @return the number of columns in the raster
+     */
+    std::size_t const &cols() const {
+        return _cols;
+    }
+
+    /**
+     * @brief Get the number of words in a row.
+     *
+     * @return the stride of the raster in words
+     */
+    std::size_t const &stride() const {
+        return _stride;
+    }
+
+    /**
+     * @brief Access the specified row of the raster.
+     *
+     * This method does not do bounds checking.
+     *
+     * @param row the row number
+     *
+     * @return a proxy for the row
+     */
+    row_proxy<word_type> operator[](std::size_t row) {
+        return row_proxy<word_type>{_data.get() + row * _stride};
+    }
+
+    /**
+     * @brief Access the specified row of the raster as a read-only
+     * array.
+     *
+     * This method does not do bounds checking.
+     *
+     * @param row the row number
+     *
+     * @return a proxy for the row
+     */
+    row_proxy<word_type const> operator[](std::size_t row) const {
+        return row_proxy<word_type const>{_data.get() + row * _stride};
+    }
+};
+
 } // namespace ppht
 
 #endif /* ppht_raster_hpp */
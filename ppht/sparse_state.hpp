@@ -0,0 +1,377 @@
+#ifndef ppht_sparse_state_hpp
+#define ppht_sparse_state_hpp
+
+#include <ppht/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief A state for images given as a list of set pixels.
+ *
+ * The class has the same interface as @ref state, but instead of a
+ * raster covering the whole image it keeps the status of the pixels
+ * that have been marked in an open-addressing hash table.  Memory and
+ * setup time are proportional to the number of set pixels rather than
+ * to the area of the image; pixels never marked read as @c unset.
+ *
+ * Given the same pixels in the same order and the same seed, the
+ * pixels are extracted in the same order as from @ref state, so @ref
+ * find_segments() gives the same result.
+ */
+class sparse_state {
+    /// A uniform random bit generator.
+    using URBG = std::default_random_engine;
+
+    /// The type of the keys of the hash table.
+    using key_type = std::uint64_t;
+
+    /// The key marking an empty slot.
+    static constexpr key_type empty_key = std::numeric_limits<key_type>::max();
+
+    /// The height of the represented image.
+    std::size_t _rows;
+
+    /// The width of the represented image.
+    std::size_t _cols;
+
+    /// The keys of the slots of the hash table.
+    std::unique_ptr<key_type[]> _keys;
+
+    /// The status of the pixel in each slot.
+    std::unique_ptr<status_t[]> _values;
+
+    /// The number of slots; a power of two.
+    std::size_t _capacity = 0;
+
+    /// The number of occupied slots.
+    std::size_t _size = 0;
+
+    /// The shift taking a hashed key to its home slot: 64 less the
+    /// base-two logarithm of @ref _capacity.
+    unsigned _shift = 64;
+
+    /// A collection of pixels marked 'pending'.
+    std::vector<point_t> _pending;
+
+    /// The URBG the class will use to select the next pending pixel.
+    URBG _urbg;
+
+    /**
+     * @brief Get the key of a pixel.
+     *
+     * @param point the pixel
+     *
+     * @return a key unique to the pixel
+     */
+    key_type key(point_t const &point) const noexcept {
+        return static_cast<key_type>(std::get<1>(point)) * _cols +
+               static_cast<key_type>(std::get<0>(point));
+    }
+
+    /**
+     * @brief Get the slot where the search for a key starts.
+     *
+     * @param k the key
+     *
+     * @return the index of the slot
+     */
+    std::size_t home(key_type k) const noexcept {
+        // Fibonacci hashing: the high bits of the product spread
+        // neighbouring pixels apart.
+        return static_cast<std::size_t>((k * 0x9E3779B97F4A7C15ULL) >>
+                                        _shift);
+    }
+
+    /**
+     * @brief Find the slot of a key, or the empty slot where it would
+     * go.
+     *
+     * @param k the key
+     *
+     * @return the index of the slot
+     */
+    std::size_t find(key_type k) const noexcept {
+        for (auto i = home(k);; i = (i + 1) & (_capacity - 1)) {
+            if (_keys[i] == k || _keys[i] == empty_key) return i;
+        }
+    }
+
+    /**
+     * @brief Resize the hash table.
+     *
+     * @param capacity the new number of slots; a power of two larger
+     *   than twice the number of occupied slots
+     */
+    void rehash(std::size_t capacity) {
+        auto keys = std::move(_keys);
+        auto values = std::move(_values);
+        auto const old_capacity = _capacity;
+
+        _keys.reset(new key_type[capacity]);
+        _values.reset(new status_t[capacity]);
+        _capacity = capacity;
+
+        for (_shift = 64; capacity > 1; capacity >>= 1) --_shift;
+
+        std::fill_n(_keys.get(), _capacity, empty_key);
+
+        for (std::size_t i = 0; i < old_capacity; ++i) {
+            if (keys[i] == empty_key) continue;
+
+            auto const j = find(keys[i]);
+            _keys[j] = keys[i];
+            _values[j] = values[i];
+        }
+    }
+
+    /**
+     * @brief Set the status of a pixel, adding it to the table if
+     * necessary.
+     *
+     * @param point the pixel
+     *
+     * @param status the new status
+     */
+    void set(point_t const &point, status_t status) {
+        if (2 * (_size + 1) > _capacity) {
+            rehash(_capacity ? 2 * _capacity : 64);
+        }
+
+        auto const k = key(point);
+        auto const i = find(k);
+
+        if (_keys[i] == empty_key) {
+            _keys[i] = k;
+            ++_size;
+        }
+
+        _values[i] = status;
+    }
+
+    /**
+     * @brief Remove a pixel from the table.
+     *
+     * The entries after it in its cluster are shifted back, so the
+     * table needs no tombstones and its slots can be reused.
+     *
+     * @param point the pixel; nothing happens if it is not in the
+     *   table
+     */
+    void erase(point_t const &point) noexcept {
+        if (_size == 0) return;
+
+        auto const mask = _capacity - 1;
+        auto i = find(key(point));
+
+        if (_keys[i] == empty_key) return;
+
+        for (auto j = (i + 1) & mask; _keys[j] != empty_key;
+             j = (j + 1) & mask) {
+            // The entry may fill the hole unless its home slot lies
+            // between the hole and the entry.
+
+            if (((j - home(_keys[j])) & mask) >= ((j - i) & mask)) {
+                _keys[i] = _keys[j];
+                _values[i] = _values[j];
+                i = j;
+            }
+        }
+
+        _keys[i] = empty_key;
+        --_size;
+    }
+
+  public:
+    /**
+     * @brief Create an empty state.
+     *
+     * @param rows the height of the represented image.
+     *
+     * @param cols the width of the represented image.
+     *
+     * @param seed the seed for the random engine.
+     */
+    sparse_state(std::size_t rows, std::size_t cols,
+                 URBG::result_type seed = std::random_device{}())
+        : _rows(rows)
+        , _cols(cols)
+        , _urbg(seed) {}
+
+    /**
+     * @brief Create a state from a list of set pixels.
+     *
+     * @tparam InputIt the type of iterator over the pixels
+     *
+     * @param rows the height of the represented image.
+     *
+     * @param cols the width of the represented image.
+     *
+     * @param first the first pixel to mark pending
+     *
+     * @param last one past the last pixel to mark pending
+     *
+     * @param seed the seed for the random engine.
+     */
+    template <class InputIt>
+    sparse_state(std::size_t rows, std::size_t cols, InputIt first,
+                 InputIt last, URBG::result_type seed = std::random_device{}())
+        : sparse_state(rows, cols, seed) {
+        for (; first != last; ++first) mark_pending(*first);
+    }
+
+    /**
+     * @brief Reserve space for a number of pixels.
+     *
+     * @param count the number of pixels expected to be marked
+     */
+    void reserve(std::size_t count) {
+        std::size_t capacity = 64;
+        while (capacity < 2 * count) capacity *= 2;
+        if (capacity > _capacity) rehash(capacity);
+        _pending.reserve(count);
+    }
+
+    /**
+     * @brief Get the number of rows of the state image.
+     *
+     * @return the height of the represented image.
+     */
+    std::size_t rows() const {
+        return _rows;
+    }
+
+    /**
+     * @brief Get the number of columns of the state image.
+     *
+     * @return the width of the represented image.
+     */
+    std::size_t cols() const {
+        return _cols;
+    }
+
+    /**
+     * @brief Get the number of pixels in the table.
+     *
+     * @return the number of pixels whose status is not @c unset
+     */
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    /**
+     * @brief Get the status of a pixel.
+     *
+     * @param point the pixel to check.
+     *
+     * @return the status of the pixel; @c unset if it was never
+     *   marked.
+     */
+    status_t status(point_t const &point) const {
+        if (_size == 0) return status_t::unset;
+
+        auto const i = find(key(point));
+        return _keys[i] == empty_key ? status_t::unset : _values[i];
+    }
+
+    /**
+     * @brief Mark a pixel as @c pending.
+     *
+     * @param point the pixel to mark.
+     */
+    void mark_pending(point_t const &point) {
+        set(point, status_t::pending);
+        _pending.emplace_back(point);
+    }
+
+    /**
+     * @brief Mark a pixel as @c done.
+     *
+     * @param point the pixel to mark.
+     */
+    void mark_done(point_t const &point) {
+        set(point, status_t::done);
+    }
+
+    /**
+     * @brief Mark a pixel as @c unset.
+     *
+     * The pixel is removed from the table, freeing its slot.
+     *
+     * @param point the pixel to mark.
+     */
+    void mark_unset(point_t const &point) {
+        erase(point);
+    }
+
+    /**
+     * @brief Empty the pending queue.
+     *
+     * The status of every pixel is kept; pixels still @c pending are
+     * no longer returned by @ref next() unless they are marked again.
+     * This is needed before reusing the object for another image when
+     * a run stopped before draining the queue: its entries would
+     * otherwise stay in the queue and change the order of later draws.
+     */
+    void clear_pending() noexcept {
+        _pending.clear();
+    }
+
+    /**
+     * @brief Reseed the random engine.
+     *
+     * @param seed the new seed for the random engine.
+     */
+    void seed(URBG::result_type seed) {
+        _urbg.seed(seed);
+    }
+
+    /**
+     * @brief Return a random pixel with @c pending status.
+     *
+     * Changes the status of the pixel to @c voted.
+     *
+     * @param point the pixel to set
+     *
+     * @return true if @c point is a valid pending pixel; false if there
+     * are no more pending pixels
+     *
+     * @sa state::next()
+     */
+    bool next(point_t &point) {
+        using index_type = typename decltype(_pending)::size_type;
+
+        while (!_pending.empty()) {
+            std::uniform_int_distribution<index_type>
+                dist{0, _pending.size() - 1};
+
+            auto &entry = _pending[dist(_urbg)];
+
+            point = entry;
+            entry = _pending.back();
+            _pending.pop_back();
+
+            // The pixel may have been unset since it was queued.
+
+            auto const i = find(key(point));
+
+            if (_keys[i] != empty_key && _values[i] == status_t::pending) {
+                _values[i] = status_t::voted;
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_sparse_state_hpp */
@@ -0,0 +1,325 @@
+#ifndef ppht_spill_raster_hpp
+#define ppht_spill_raster_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ppht {
+
+/**
+ * @brief A 2D array of counters stored in eight bits with overflow
+ * to a side table.
+ *
+ * Each cell takes one byte.  Values up to 254 are stored in the cell
+ * itself; a cell holding 255 has its true value in a hash table
+ * keyed by the position of the cell.  For the accumulator, where
+ * almost every counter stays small, this halves the size of the
+ * counter matrix compared to 16-bit counters while remaining exact on
+ * images with very long lines.
+ *
+ * The interface is the same as that of @ref raster except that
+ * operator[] returns a proxy for the row, whose operator[] returns a
+ * proxy @ref reference supporting increment, decrement, assignment
+ * and conversion to @c T for a mutable raster, and a value for a
+ * const one.  Cells in different columns may be updated
+ * concurrently: the side table is protected by a mutex, which is
+ * only taken for cells that have overflowed.  Does not perform bounds
+ * checking.
+ *
+ * @tparam T the logical type of the counters; an unsigned integer type
+ */
+template <class T>
+class spill_raster {
+    /// The cell value that marks a spilled counter.
+    static constexpr std::uint8_t spilled = 0xFF;
+
+    /// The cells of the raster.
+    std::unique_ptr<std::uint8_t[]> _data;
+
+    /// The height of this raster.
+    std::size_t const _rows;
+
+    /// The width of this raster.
+    std::size_t const _cols;
+
+    /// The values of the spilled counters, by index of the cell.
+    std::unordered_map<std::size_t, T> _spill;
+
+    /// Protects @ref _spill.
+    mutable std::mutex _mutex;
+
+    /**
+     * @brief Get the value of a cell.
+     *
+     * @param index the index of the cell
+     *
+     * @return the value of the cell
+     */
+    T get(std::size_t index) const {
+        auto const cell = _data[index];
+        if (cell != spilled) return cell;
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _spill.at(index);
+    }
+
+    /**
+     * @brief Set the value of a cell.
+     *
+     * @param index the index of the cell
+     *
+     * @param value the new value of the cell
+     */
+    void set(std::size_t index, T value) {
+        auto &cell = _data[index];
+
+        if (cell != spilled && value < spilled) {
+            cell = static_cast<std::uint8_t>(value);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock{_mutex};
+
+        if (value < spilled) {
+            _spill.erase(index);
+            cell = static_cast<std::uint8_t>(value);
+        }
+        else {
+            _spill[index] = value;
+            cell = spilled;
+        }
+    }
+
+  public:
+    /// The type of the cells of this raster.
+    using value_type = T;
+
+    /**
+     * @brief A proxy for a counter of a mutable raster.
+     */
+    class reference {
+        /// The raster holding the counter.
+        spill_raster *_raster;
+
+        /// The index of the cell.
+        std::size_t _index;
+
+      public:
+        /**
+         * @brief Construct a reference.
+         *
+         * @param raster the raster holding the counter
+         *
+         * @param index the index of the cell
+         */
+        reference(spill_raster *raster, std::size_t index) noexcept
+            : _raster(raster)
+            , _index(index) {}
+
+        /**
+         * @brief Read the counter.
+         *
+         * @return the value of the counter
+         */
+        operator T() const {
+            return _raster->get(_index);
+        }
+
+        /**
+         * @brief Write the counter.
+         *
+         * @param value the new value of the counter
+         *
+         * @return the reference
+         */
+        reference &operator=(T value) {
+            _raster->set(_index, value);
+            return *this;
+        }
+
+        /**
+         * @brief Copy the value of another counter.
+         *
+         * @param r the counter to copy
+         *
+         * @return the reference
+         */
+        reference &operator=(reference const &r) {
+            return *this = static_cast<T>(r);
+        }
+
+        /**
+         * @brief Increment the counter.
+         *
+         * @return the reference
+         */
+        reference &operator++() {
+            auto &cell = _raster->_data[_index];
+
+            if (cell < spilled - 1) {
+                ++cell;
+                return *this;
+            }
+
+            return *this = static_cast<T>(*this + 1);
+        }
+
+        /**
+         * @brief Decrement the counter.
+         *
+         * @return the reference
+         */
+        reference &operator--() {
+            auto &cell = _raster->_data[_index];
+
+            if (cell != spilled) {
+                --cell;
+                return *this;
+            }
+
+            return *this = static_cast<T>(*this - 1);
+        }
+    };
+
+    /**
+     * @brief A proxy for a row of the raster.
+     *
+     * @tparam Raster the (possibly const-qualified) raster type
+     */
+    template <class Raster>
+    class row_proxy {
+        /// The raster.
+        Raster *_raster;
+
+        /// The index of the first cell of the row.
+        std::size_t _base;
+
+      public:
+        /**
+         * @brief Construct a row proxy.
+         *
+         * @param raster the raster
+         *
+         * @param base the index of the first cell of the row
+         */
+        row_proxy(Raster *raster, std::size_t base) noexcept
+            : _raster(raster)
+            , _base(base) {}
+
+        /**
+         * @brief Access the specified column of the row.
+         *
+         * @param col the column number
+         *
+         * @return a @ref reference to the counter, or its value if
+         *   the raster is const
+         */
+        auto operator[](std::size_t col) const {
+            return access(_raster, _base + col);
+        }
+    };
+
+  private:
+    /**
+     * @brief Get a writable counter.
+     *
+     * @param raster the raster
+     *
+     * @param index the index of the cell
+     *
+     * @return a reference to the counter
+     */
+    static reference access(spill_raster *raster, std::size_t index) {
+        return reference{raster, index};
+    }
+
+    /**
+     * @brief Get the value of a counter.
+     *
+     * @param raster the raster
+     *
+     * @param index the index of the cell
+     *
+     * @return the value of the counter
+     */
+    static T access(spill_raster const *raster, std::size_t index) {
+        return raster->get(index);
+    }
+
+  public:
+    /**
+     * @brief Create a new raster with the given size.
+     *
+     * All counters are initialized to zero.
+     *
+     * @param rows the number of rows (height) of the raster.
+     *
+     * @param cols the number of columns (width) of the raster.
+     */
+    spill_raster(std::size_t rows, std::size_t cols)
+        : _data(new std::uint8_t[rows * cols]{})
+        , _rows(rows)
+        , _cols(cols) {}
+
+    /**
+     * @brief Get the height of the raster.
+     *
+     * @return the number of rows in the raster
+     */
+    std::size_t const &rows() const {
+        return _rows;
+    }
+
+    /**
+     * @brief Get the width of the raster.
+     *
+     * @return the number of columns in the raster
+     */
+    std::size_t const &cols() const {
+        return _cols;
+    }
+
+    /**
+     * @brief Get the number of counters stored in the side table.
+     *
+     * @return the number of cells that have overflowed
+     */
+    std::size_t spilled_cells() const {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _spill.size();
+    }
+
+    /**
+     * @brief Access the specified row of the raster.
+     *
+     * This method does not do bounds checking.
+     *
+     * @param row the row number
+     *
+     * @return a proxy for the row
+     */
+    row_proxy<spill_raster> operator[](std::size_t row) {
+        return row_proxy<spill_raster>{this, row * _cols};
+    }
+
+    /**
+     * @brief Access the specified row of the raster as a read-only
+     * array.
+     *
+     * This method does not do bounds checking.
+     *
+     * @param row the row number
+     *
+     * @return a proxy for the row
+     */
+    row_proxy<spill_raster const> operator[](std::size_t row) const {
+        return row_proxy<spill_raster const>{this, row * _cols};
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_spill_raster_hpp */
@@ -7,10 +7,10 @@
 #include <ppht/types.hpp>
 
 #include <algorithm>
-#include <cassert>
 #include <cmath>
 #include <random>
-#include <set>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace ppht {
@@ -23,6 +23,9 @@ namespace ppht {
  * Once the image is loaded, pixels marked "pending" can be extracted
  * in random order.  Extracting a pixel marks it as "voted."  Once
  * fully processed, any pixel may be marked "done."
+ *
+ * @tparam Raster the class used for the status of the pixels; @ref
+ *   packed_raster uses two bits per pixel
  */
 template <template <class> class Raster = raster>
 class state {
@@ -75,9 +78,9 @@ class state {
         , _urbg(seed) {
         point_t p;
 
-        for (p[1] = 0; p[1] < _state.rows; ++p[1]) {
+        for (p[1] = 0; p[1] < static_cast<long>(_state.rows()); ++p[1]) {
             auto const row = _state[p[1]];
-            for (p[0] = 0; p[0] < _state.cols; ++p[0]) {
+            for (p[0] = 0; p[0] < static_cast<long>(_state.cols()); ++p[0]) {
                 if (row[p[0]] == status_t::pending) {
                     _pending.push_back(p);
                 }
@@ -85,6 +88,32 @@ class state {
         }
     }
 
+    /**
+     * @brief Construct a state from a view of an image.
+     *
+     * The set pixels of the view are marked pending in a single pass;
+     * the image is not copied.  The view must provide @c rows(), @c
+     * cols() and @c for_each_set(f), which calls @c f with every set
+     * pixel in raster order.
+     *
+     * @tparam View the class of the view
+     *
+     * @param view the image from which to load the state
+     *
+     * @param seed the seed for the random engine
+     *
+     * @sa byte_image_view, bit_image_view
+     */
+    template <class View,
+              class = decltype(std::declval<View const &>().for_each_set(
+                  std::declval<void (*)(point_t const &)>()))>
+    explicit state(View const &view,
+                   URBG::result_type seed = std::random_device{}())
+        : _state(view.rows(), view.cols())
+        , _urbg(seed) {
+        view.for_each_set([this](point_t const &p) { mark_pending(p); });
+    }
+
     /**
      * @brief Get the number of rows of the state image.
      *
@@ -139,12 +168,57 @@ class state {
         _state[y][x] = status_t::done;
     }
 
+    /**
+     * @brief Mark a pixel in the raster as @c unset.
+     *
+     * If the pixel is in the pending queue, it will be discarded by
+     * @ref next().
+     *
+     * @param point the pixel to mark.
+     */
+    void mark_unset(point_t const &point) {
+        auto const x = std::get<0>(point);
+        auto const y = std::get<1>(point);
+
+        _state[y][x] = status_t::unset;
+    }
+
+    /**
+     * @brief Empty the pending queue.
+     *
+     * The status of every pixel is kept; pixels still @c pending are
+     * no longer returned by @ref next() unless they are marked again.
+     * This is needed before reusing the object for another image when
+     * a run stopped before draining the queue: its entries would
+     * otherwise stay in the queue and change the order of later draws.
+     */
+    void clear_pending() noexcept {
+        _pending.clear();
+    }
+
+    /**
+     * @brief Reseed the random engine.
+     *
+     * @param seed the new seed for the random engine.
+     */
+    void seed(URBG::result_type seed) {
+        _urbg.seed(seed);
+    }
+
     /**
      * @brief Return a random pixel with @c pending status.
      *
-     * Changes the status of the pixel to @c voted.  If the status of
-     * the next pixel in the queue has been updated elsewhere, the
-     * pixel is removed from the queue and not returned.
+     * Changes the status of the pixel to @c voted.  Entries of the
+     * queue whose status has been updated elsewhere are discarded
+     * lazily: a random entry is removed from the queue (by moving the
+     * last entry into its place) and, if it is no longer pending,
+     * another one is drawn.  Since every entry is removed at most
+     * once, the cost is constant amortized over the image.
+     *
+     * Only the drawn entry and the last entry of the queue are
+     * touched, so the queue could be split among several workers,
+     * each drawing from its own part, without changing the
+     * algorithm.
      *
      * @param point the pixel to set
      *
@@ -152,38 +226,32 @@ class state {
      * are no more pending pixels in the raster
      */
     bool next(point_t &point) {
-        auto begin = _pending.begin();
-        auto end = _pending.end();
-
-        end = std::remove_if(begin, end, [this](auto &&p) {
-            return status(p) != status_t::pending;
-        });
-
-        _pending.erase(end, _pending.end());
-
-        if (begin == end) return false;
+        using index_type = typename decltype(_pending)::size_type;
 
-        using index_type = typename decltype(_pending)::difference_type;
+        while (!_pending.empty()) {
+            std::uniform_int_distribution<index_type>
+                dist{0, _pending.size() - 1};
 
-        std::uniform_int_distribution<index_type>
-            dist{0, std::distance(begin, end) - 1};
+            auto &entry = _pending[dist(_urbg)];
 
-        auto iter = begin + dist(_urbg);
+            point = entry;
+            entry = _pending.back();
+            _pending.pop_back();
 
-        point = std::exchange(*iter, *(--end));
+            auto &&cell = _state[std::get<1>(point)][std::get<0>(point)];
 
-        auto &cell = _state[std::get<1>(point)][std::get<0>(point)];
-
-        assert(cell == status_t::pending);
-
-        cell = status_t::voted;
+            if (cell == status_t::pending) {
+                cell = status_t::voted;
+                return true;
+            }
+        }
 
-        return true;
+        return false;
     }
 };
 
 /**
- * @brief Return a set of offsets that are within a radius.
+ * @brief Compute the offsets that are within a radius.
  *
  * The number of offsets generated is controlled by the @c radius
  * parameter.  For a radius @f$r@f$, the returned offsets will be
@@ -196,12 +264,13 @@ class state {
  *
  * @param radius determines the number of offsets to calculate.
  *
- * @return a non-empty set of offsets.
+ * @param result replaced by the offsets, sorted and without
+ *   duplicates; never empty.
  *
  * @sa scan()
  */
-static inline std::set<point_t>
-find_offsets(segment_t const &segment, unsigned radius) {
+static inline void find_offsets(segment_t const &segment, unsigned radius,
+                                std::vector<point_t> &result) {
     // The vector [xn, yn] is normal to the segment.
 
     double xn = std::get<1>(segment.second);
@@ -214,19 +283,60 @@ find_offsets(segment_t const &segment, unsigned radius) {
     double len = std::hypot(xn, yn);
     xn /= len, yn /= len;
 
-    std::set<point_t> result{{0, 0}};
+    result.clear();
+    result.emplace_back(0, 0);
 
     for (auto r = 1U; r <= radius; ++r) {
         auto dx = std::lround(xn * r);
         auto dy = std::lround(yn * r);
 
-        result.emplace(dx, dy);
-        result.emplace(-dx, -dy);
+        result.emplace_back(dx, dy);
+        result.emplace_back(-dx, -dy);
     }
 
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+/**
+ * @brief Return a set of offsets that are within a radius.
+ *
+ * @param segment used to determine the orientation of the perpendicular.
+ *
+ * @param radius determines the number of offsets to calculate.
+ *
+ * @return a non-empty sorted vector of distinct offsets.
+ *
+ * @sa find_offsets(segment_t const &, unsigned, std::vector<point_t> &)
+ */
+static inline std::vector<point_t>
+find_offsets(segment_t const &segment, unsigned radius) {
+    std::vector<point_t> result;
+    find_offsets(segment, radius, result);
     return result;
 }
 
+/**
+ * @brief Scratch storage for @ref scan().
+ *
+ * Passing the same buffer to successive scans lets them run without
+ * allocating once the vectors have grown to the size of the longest
+ * channel.
+ */
+struct scan_buffer {
+    /// The offsets of the current channel.
+    std::vector<point_t> offsets;
+
+    /// The set pixels around the current canonical point.
+    std::vector<point_t> hits;
+
+    /// The segment being traced.
+    point_set current;
+
+    /// The longest segment traced so far.
+    point_set best;
+};
+
 /**
  * @brief Trace a scan channel.
  *
@@ -236,7 +346,10 @@ find_offsets(segment_t const &segment, unsigned radius) {
  * set, add the canonical point to the current segment.  At the end of
  * a gap of @c max_gap pixels, end the current segment and start a new
  * one.  Upon completion of the scan, return the longest segment found
- * so far.
+ * so far; if several are equally long, the first one.
+ *
+ * @tparam State the class of the state, e.g., @ref state or @ref
+ *   sparse_state
  *
  * @param s the state object to update
  *
@@ -248,27 +361,36 @@ find_offsets(segment_t const &segment, unsigned radius) {
  * @param max_gap the number of consecutive missed pixels that can
  *   appear in a segment
  *
- * @returns a @ref point_set around the longest segment found
+ * @param buffer scratch storage, reused from one scan to the next
+ *
+ * @returns a @ref point_set around the longest segment found; a
+ *   reference to @c buffer.best
  *
  * @throws std::logic_error if no points are set in the scan channel
  *
  * @sa find_offsets()
  */
-template <template <class> class Raster>
-point_set scan(state<Raster> &s, segment_t const &segment, unsigned radius,
-               unsigned max_gap) {
-    auto const offsets = find_offsets(segment, radius);
+template <class State>
+point_set const &scan(State &s, segment_t const &segment,
+                      unsigned radius, unsigned max_gap,
+                      scan_buffer &buffer) {
+    find_offsets(segment, radius, buffer.offsets);
+
+    auto &hits = buffer.hits;
+    auto &current = buffer.current;
+    auto &best = buffer.best;
+
+    current.clear();
+    best.clear();
 
     // The initial gap is technically infinite, but anything
     // larger than max_gap will do.
     auto gap = max_gap + 1;
 
-    std::vector<point_set> point_sets;
+    channel(segment).for_each([&](point_t const &point) {
+        hits.clear();
 
-    for (auto const &point : channel(segment)) {
-        std::set<point_t> points;
-
-        for (auto const &offset : offsets) {
+        for (auto const &offset : buffer.offsets) {
             auto p = point + offset;
 
             if (p[0] < 0 || p[0] >= static_cast<long>(s.cols())) continue;
@@ -277,29 +399,64 @@ point_set scan(state<Raster> &s, segment_t const &segment, unsigned radius,
             auto status = s.status(p);
 
             if (status == status_t::pending || status == status_t::voted) {
-                points.emplace(p);
+                hits.push_back(p);
             }
         }
 
-        if (points.empty()) { // no hits
+        if (hits.empty()) { // no hits
             ++gap;
         }
         else {
-            // If the gap is too large to ignore, start a new point set.
-            if (gap > max_gap) point_sets.emplace_back();
-            point_sets.back().add_point(point, points);
+            // If the gap is too large to ignore, start a new point
+            // set, keeping the old one if it is the longest so far.
+            if (gap > max_gap) {
+                if (best < current) std::swap(best, current);
+                current.clear();
+            }
+
+            current.add_point(point, hits);
 
             gap = 0;
         }
-    }
+    });
+
+    if (best < current) std::swap(best, current);
 
-    if (point_sets.empty()) {
+    if (best.empty()) {
         throw std::logic_error{"channel contained no viable segments"};
     }
 
-    auto longest = std::max_element(point_sets.begin(), point_sets.end());
+    return best;
+}
 
-    return *longest;
+/**
+ * @brief Trace a scan channel.
+ *
+ * @tparam State the class of the state, e.g., @ref state or @ref
+ *   sparse_state
+ *
+ * @param s the state object to update
+ *
+ * @param segment the canonical segment of the scan channel
+ *
+ * @param radius the number of pixels to check around the canonical
+ *   segment
+ *
+ * @param max_gap the number of consecutive missed pixels that can
+ *   appear in a segment
+ *
+ * @returns a @ref point_set around the longest segment found
+ *
+ * @throws std::logic_error if no points are set in the scan channel
+ *
+ * @sa scan(State &, segment_t const &, unsigned, unsigned, scan_buffer &)
+ */
+template <class State>
+point_set scan(State &s, segment_t const &segment, unsigned radius,
+               unsigned max_gap) {
+    scan_buffer buffer;
+    scan(s, segment, radius, max_gap, buffer);
+    return std::move(buffer.best);
 }
 
 } // namespace ppht
@@ -0,0 +1,230 @@
+#ifndef ppht_thread_pool_hpp
+#define ppht_thread_pool_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief A fixed-size pool of threads executing fork-join loops.
+ *
+ * The pool runs one @ref parallel_for() at a time.  The calling
+ * thread takes part in the loop, so a pool of size @f$n@f$ starts
+ * @f$n-1@f$ worker threads.
+ *
+ * Because the pool is meant for loops that are issued many times per
+ * second (e.g., once per vote), idle workers spin briefly before
+ * going to sleep, and the loop is dispatched without allocating.
+ *
+ * @note @ref parallel_for() is not reentrant: the loop body must not
+ * call @ref parallel_for() on the same pool.
+ */
+class thread_pool {
+    /// The number of times an idle thread polls before sleeping.
+    static constexpr unsigned spin_limit = 1024;
+
+    /// The worker threads.
+    std::vector<std::thread> _threads;
+
+    /// Protects the sleeping states of the threads.
+    std::mutex _mutex;
+
+    /// Signalled when a new loop starts.
+    std::condition_variable _start;
+
+    /// Signalled when the last worker finishes a loop.
+    std::condition_variable _finish;
+
+    /// Incremented for each loop; workers wait for it to change.
+    std::atomic<std::size_t> _generation{0};
+
+    /// The number of workers that have not finished the loop.
+    std::atomic<std::size_t> _running{0};
+
+    /// The next index of the loop to claim.
+    std::atomic<std::size_t> _next{0};
+
+    /// The number of indices in the loop.
+    std::size_t _count = 0;
+
+    /// Type-erased loop body.
+    void (*_invoke)(void *, std::size_t) = nullptr;
+
+    /// The loop body passed to @ref _invoke.
+    void *_body = nullptr;
+
+    /// The first exception thrown by the loop body.
+    std::exception_ptr _error;
+
+    /// Set when the pool is being destroyed.
+    bool _stop = false;
+
+    /**
+     * @brief Claim and run indices until the loop is exhausted.
+     */
+    void run() noexcept {
+        for (;;) {
+            auto const i = _next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= _count) break;
+
+            try {
+                _invoke(_body, i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock{_mutex};
+                if (!_error) _error = std::current_exception();
+            }
+        }
+    }
+
+    /**
+     * @brief The main loop of a worker thread.
+     */
+    void work() noexcept {
+        std::size_t seen = 0;
+
+        for (;;) {
+            for (unsigned spin = 0;
+                 _generation.load(std::memory_order_acquire) == seen;
+                 ++spin) {
+                if (spin < spin_limit) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock{_mutex};
+                _start.wait(lock, [&] {
+                    return _generation.load(std::memory_order_acquire) !=
+                           seen;
+                });
+            }
+
+            ++seen;
+
+            if (_stop) return;
+
+            run();
+
+            if (_running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock{_mutex};
+                _finish.notify_one();
+            }
+        }
+    }
+
+  public:
+    /**
+     * @brief Create a pool.
+     *
+     * @param threads the number of threads to use, including the
+     *   calling thread; zero selects the hardware concurrency
+     */
+    explicit thread_pool(std::size_t threads = 0) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+
+        _threads.reserve(threads - 1);
+
+        for (std::size_t i = 1; i < threads; ++i) {
+            _threads.emplace_back(&thread_pool::work, this);
+        }
+    }
+
+    thread_pool(thread_pool const &) = delete;
+    thread_pool &operator=(thread_pool const &) = delete;
+
+    /**
+     * @brief Stop and join the worker threads.
+     */
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _stop = true;
+            _generation.fetch_add(1, std::memory_order_release);
+        }
+
+        _start.notify_all();
+
+        for (auto &thread : _threads) thread.join();
+    }
+
+    /**
+     * @brief Get the number of threads taking part in a loop.
+     *
+     * @return the number of workers plus one
+     */
+    std::size_t size() const noexcept {
+        return _threads.size() + 1;
+    }
+
+    /**
+     * @brief Call a function for each index of a range, in parallel.
+     *
+     * Calls <code>f(i)</code> for every @c i in [0, @c count) and
+     * returns once all of the calls have completed.  The order of the
+     * calls and their assignment to threads is unspecified.
+     *
+     * @tparam F the type of the loop body
+     *
+     * @param count the number of indices
+     *
+     * @param f the loop body
+     *
+     * @throws any exception thrown by @c f; if several calls throw,
+     *   the first one caught is rethrown after the loop completes
+     */
+    template <class F>
+    void parallel_for(std::size_t count, F &&f) {
+        if (_threads.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) f(i);
+            return;
+        }
+
+        using body_t = typename std::remove_reference<F>::type;
+
+        _invoke = [](void *body, std::size_t i) {
+            (*static_cast<body_t *>(body))(i);
+        };
+        _body = const_cast<void *>(static_cast<void const *>(&f));
+        _count = count;
+        _next.store(0, std::memory_order_relaxed);
+        _running.store(_threads.size(), std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _generation.fetch_add(1, std::memory_order_release);
+        }
+
+        _start.notify_all();
+
+        run();
+
+        for (unsigned spin = 0;
+             _running.load(std::memory_order_acquire) != 0; ++spin) {
+            if (spin < spin_limit) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{_mutex};
+            _finish.wait(lock, [&] {
+                return _running.load(std::memory_order_acquire) == 0;
+            });
+        }
+
+        if (_error) std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+};
+
+} // namespace ppht
+
+#endif /* ppht_thread_pool_hpp */
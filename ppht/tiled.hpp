@@ -0,0 +1,318 @@
+#ifndef ppht_tiled_hpp
+#define ppht_tiled_hpp
+
+#include <ppht.hpp>
+#include <ppht/thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ppht {
+
+/**
+ * @brief The tunable parameters of the tiled driver.
+ *
+ * @sa find_segments_tiled()
+ */
+struct tiling {
+    /**
+     * @brief The width and height of the core of a tile.
+     *
+     * Tiles at the right and bottom edges of the image may be
+     * smaller.
+     */
+    std::size_t tile_size = 1024;
+
+    /**
+     * @brief The number of pixels by which a tile extends past its
+     * core on every side.
+     *
+     * Pixels in the overlap give the detector context near the edges
+     * of the core; segments found there are clipped to the core.
+     */
+    std::size_t overlap = 32;
+
+    /**
+     * @brief The number of threads to use.
+     *
+     * Zero selects the hardware concurrency.
+     */
+    std::size_t threads = 0;
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param tile_size the new value for @ref tile_size
+     *
+     * @return the tiling object
+     */
+    tiling &set_tile_size(std::size_t tile_size) {
+        this->tile_size = tile_size;
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param overlap the new value for @ref overlap
+     *
+     * @return the tiling object
+     */
+    tiling &set_overlap(std::size_t overlap) {
+        this->overlap = overlap;
+        return *this;
+    }
+
+    /**
+     * @brief Chained constructor operation.
+     *
+     * @param threads the new value for @ref threads
+     *
+     * @return the tiling object
+     */
+    tiling &set_threads(std::size_t threads) {
+        this->threads = threads;
+        return *this;
+    }
+};
+
+/**
+ * @brief Derive a seed for a sub-problem from a master seed.
+ *
+ * Uses the SplitMix64 finalizer, so nearby indices give unrelated
+ * seeds.  The result depends only on the arguments; it is used to
+ * make parallel runs reproducible regardless of scheduling.
+ *
+ * @param seed the master seed
+ *
+ * @param index the index of the sub-problem
+ *
+ * @return a seed for the sub-problem
+ */
+static inline std::random_device::result_type
+derive_seed(std::random_device::result_type seed, std::size_t index) noexcept {
+    std::uint64_t z = seed;
+    z += (static_cast<std::uint64_t>(index) + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return static_cast<std::random_device::result_type>(z);
+}
+
+/**
+ * @brief Clip a segment to a closed rectangle.
+ *
+ * Uses the Liang-Barsky algorithm; the new endpoints are rounded to
+ * the nearest pixel.
+ *
+ * @param segment the segment to clip; updated in place
+ *
+ * @param lo the top left corner of the rectangle
+ *
+ * @param hi the bottom right corner of the rectangle (inclusive)
+ *
+ * @return false if no part of the segment lies in the rectangle
+ */
+static inline bool clip_segment(segment_t &segment, point_t const &lo,
+                                point_t const &hi) {
+    double const x0 = std::get<0>(segment.first);
+    double const y0 = std::get<1>(segment.first);
+    double const dx = std::get<0>(segment.second) - x0;
+    double const dy = std::get<1>(segment.second) - y0;
+
+    double t0 = 0, t1 = 1;
+
+    auto edge = [&](double p, double q) {
+        if (p == 0) return q >= 0;
+
+        auto const t = q / p;
+
+        if (p < 0) {
+            if (t > t1) return false;
+            t0 = std::max(t0, t);
+        }
+        else {
+            if (t < t0) return false;
+            t1 = std::min(t1, t);
+        }
+
+        return true;
+    };
+
+    if (!edge(-dx, x0 - std::get<0>(lo))) return false;
+    if (!edge(dx, std::get<0>(hi) - x0)) return false;
+    if (!edge(-dy, y0 - std::get<1>(lo))) return false;
+    if (!edge(dy, std::get<1>(hi) - y0)) return false;
+
+    if (t0 > 0) {
+        segment.first = point_t{std::lround(x0 + t0 * dx),
+                                std::lround(y0 + t0 * dy)};
+    }
+    if (t1 < 1) {
+        segment.second = point_t{std::lround(x0 + t1 * dx),
+                                 std::lround(y0 + t1 * dy)};
+    }
+
+    return true;
+}
+
+/**
+ * @brief Run the PPHT algorithm on overlapping tiles of an image.
+ *
+ * The image is divided into square cores of @ref tiling::tile_size
+ * pixels.  Each core, extended by @ref tiling::overlap pixels on
+ * every side, is loaded into its own @ref state and processed by @ref
+ * find_segments() on a thread pool, so memory use is bounded by the
+ * tile size rather than the image size.  The segments of each tile
+ * are clipped to its core: segments that end inside the core are kept
+ * as they are, and the pieces of segments that leave it are merged
+ * with the pieces found by the neighboring tiles using @ref
+ * postprocess().  Merged pieces that are still shorter than @ref
+ * parameters::min_length are discarded.
+ *
+ * The image may be any object providing @c rows(), @c cols() and @c
+ * status(point_t); pixels with status @c pending or @c voted are
+ * considered set.  The image is only read, concurrently.
+ *
+ * <b>Differences from a single run.</b> The result is deterministic
+ * for a given image, seed and tile layout, whatever the number of
+ * threads, but it is not the same as that of @ref find_segments() on
+ * the whole image:
+ *
+ * - each tile samples its pixels in its own random order (the seed of
+ *   a tile is derived from @c seed and the index of the tile);
+ *
+ * - the accumulator of a tile is sized from the diagonal of the tile,
+ *   so its rho bins are narrower and the null-hypothesis statistics
+ *   are local to the tile;
+ *
+ * - a segment crossing a seam is recovered only if the pieces found
+ *   on either side meet within @ref parameters::channel_width pixels
+ *   and are colinear within that tolerance; otherwise it is reported
+ *   as two or more segments, and pieces shorter than @ref
+ *   parameters::min_length are lost;
+ *
+ * - a segment lying close to and along a seam may be reported by both
+ *   neighbouring tiles.
+ *
+ * An overlap of at least @ref parameters::min_length is recommended.
+ *
+ * @tparam Image the class of the image
+ *
+ * @tparam Accumulator the class to use for the accumulator of a tile
+ *
+ * @param image the image to analyze
+ *
+ * @param tiles the tiling parameters
+ *
+ * @param param tuning parameters for each tile
+ *
+ * @param seed a value from which the seeds of the tiles are derived
+ *
+ * @returns a vector of line segments
+ */
+template <class Image, class Accumulator = accumulator<>>
+std::vector<segment_t>
+find_segments_tiled(Image const &image, tiling const &tiles = tiling{},
+                    parameters const &param = parameters{},
+                    std::random_device::result_type seed =
+                        std::random_device{}()) {
+    long const rows = image.rows();
+    long const cols = image.cols();
+    long const size = std::max<std::size_t>(tiles.tile_size, 1);
+    long const overlap = tiles.overlap;
+
+    long const tiles_down = (rows + size - 1) / size;
+    long const tiles_across = (cols + size - 1) / size;
+
+    // Interior segments of each tile, then the pieces that cross the
+    // edge of its core.
+
+    std::vector<std::vector<segment_t>> interior(tiles_down * tiles_across);
+    std::vector<std::vector<segment_t>> pieces(interior.size());
+
+    thread_pool pool{tiles.threads};
+
+    pool.parallel_for(interior.size(), [&](std::size_t index) {
+        long const ty = index / tiles_across;
+        long const tx = index % tiles_across;
+
+        // The core is [x0, x1) x [y0, y1); the tile extends it by the
+        // overlap, within the bounds of the image.
+
+        long const x0 = tx * size, x1 = std::min(x0 + size, cols);
+        long const y0 = ty * size, y1 = std::min(y0 + size, rows);
+        long const ex0 = std::max(x0 - overlap, 0L);
+        long const ey0 = std::max(y0 - overlap, 0L);
+        long const ex1 = std::min(x1 + overlap, cols);
+        long const ey1 = std::min(y1 + overlap, rows);
+
+        state<> tile(ey1 - ey0, ex1 - ex0, derive_seed(seed, index));
+
+        point_t p;
+
+        for (p[1] = ey0; p[1] < ey1; ++p[1]) {
+            for (p[0] = ex0; p[0] < ex1; ++p[0]) {
+                auto const status = image.status(p);
+
+                if (status == status_t::pending ||
+                    status == status_t::voted) {
+                    tile.mark_pending(p - point_t{ex0, ey0});
+                }
+            }
+        }
+
+        auto segments = find_segments<state<> &, Accumulator>(
+            tile, param, derive_seed(seed, index));
+
+        // The pieces are clipped to the closed core so that the piece
+        // on either side of a seam ends on the seam itself.
+
+        point_t const lo{x0, y0};
+        point_t const hi{std::min(x1, cols - 1), std::min(y1, rows - 1)};
+
+        auto const inside = [&](point_t const &q) {
+            return x0 <= q[0] && q[0] < x1 && y0 <= q[1] && q[1] < y1;
+        };
+
+        for (auto segment : segments) {
+            segment.first = segment.first + point_t{ex0, ey0};
+            segment.second = segment.second + point_t{ex0, ey0};
+
+            if (inside(segment.first) && inside(segment.second)) {
+                interior[index].push_back(segment);
+            }
+            else if (clip_segment(segment, lo, hi) &&
+                     segment.first != segment.second) {
+                pieces[index].push_back(segment);
+            }
+        }
+    });
+
+    std::vector<segment_t> result, seams;
+
+    for (auto &&v : interior) result.insert(result.end(), v.begin(), v.end());
+    for (auto &&v : pieces) seams.insert(seams.end(), v.begin(), v.end());
+
+    seams.erase(postprocess(seams.begin(), seams.end(), param.channel_width),
+                seams.end());
+
+    long const min_length_squared = param.min_length * param.min_length;
+
+    for (auto &&segment : seams) {
+        if ((segment.second - segment.first).length_squared() >=
+            min_length_squared) {
+            result.push_back(segment);
+        }
+    }
+
+    return result;
+}
+
+} // namespace ppht
+
+#endif /* ppht_tiled_hpp */
@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <math.h>
 #include <memory>
+#include <stdexcept>
 #include <utility>
 
 namespace ppht {
@@ -17,13 +18,61 @@ namespace ppht {
  *
  * A @c trig_table contains sine and cosine values for the semiturn
  * (180°) indexed by a user-specified measurement called "parts."
+ *
+ * The cosines and sines are kept in separate contiguous arrays, each
+ * aligned to @ref alignment bytes, so that vectorized kernels can
+ * load consecutive angles directly.
  */
 class trig_table {
     /// Pair describing cosine and sine value for a given measurement.
     using cossin_t = std::pair<double, double>;
 
-    /// The table of values.
-    std::unique_ptr<cossin_t[]> _data;
+  public:
+    /// The alignment (in bytes) of the cosine and sine arrays.
+    static constexpr std::size_t alignment = 64;
+
+  private:
+    /// The storage backing both arrays.
+    std::unique_ptr<double[]> _data;
+
+    /// The cosine values, aligned within @ref _data.
+    double *_cos;
+
+    /// The sine values, aligned within @ref _data.
+    double *_sin;
+
+    /**
+     * @brief Number of doubles by which each array is padded.
+     *
+     * Rounding each array up to a multiple of this value keeps the
+     * second array aligned if the first one is.
+     */
+    static constexpr std::size_t pad = alignment / sizeof(double);
+
+    /**
+     * @brief Round a count of doubles up to a multiple of @ref pad.
+     *
+     * @param n the number of elements
+     *
+     * @return the padded number of elements
+     */
+    static constexpr std::size_t padded(std::size_t n) noexcept {
+        return (n + pad - 1) / pad * pad;
+    }
+
+    /**
+     * @brief Construct a table over arrays it does not own.
+     *
+     * @param cos the cosine values
+     *
+     * @param sin the sine values
+     *
+     * @param max_theta parts per semiturn
+     */
+    trig_table(double *cos, double *sin, std::size_t max_theta) noexcept
+        : _cos(cos)
+        , _sin(sin)
+        , max_theta(max_theta) {}
 
   public:
     /**
@@ -43,24 +92,49 @@ class trig_table {
      * @param max_theta parts per semiturn
      */
     explicit trig_table(std::size_t max_theta)
-        : _data(new cossin_t[max_theta])
+        : _data(new double[2 * padded(max_theta) + pad])
         , max_theta(max_theta) {
         if (max_theta % 2 != 0) {
             throw std::invalid_argument{"max_theta not even"};
         }
 
+        void *start = _data.get();
+        std::size_t space = (2 * padded(max_theta) + pad) * sizeof(double);
+
+        std::align(alignment, 2 * padded(max_theta) * sizeof(double),
+                   start, space);
+
+        _cos = static_cast<double *>(start);
+        _sin = _cos + padded(max_theta);
+
         auto const radians_per_part =
             4.0 * std::atan2(1, 1) / static_cast<double>(max_theta);
 
         for (std::size_t theta = 0; theta < max_theta / 2; ++theta) {
             auto const angle = theta * radians_per_part;
-            auto const s = sin(angle), c = cos(angle);
+            auto const s = std::sin(angle), c = std::cos(angle);
 
-            _data[theta] = cossin_t{c, s};
-            _data[theta + max_theta / 2] = cossin_t{-s, c};
+            _cos[theta] = c, _sin[theta] = s;
+            _cos[theta + max_theta / 2] = -s, _sin[theta + max_theta / 2] = c;
         }
     }
 
+    /**
+     * @brief Construct a table sharing the arrays of another.
+     *
+     * Nothing is computed or allocated.
+     *
+     * @param other the table whose arrays are used; must outlive the
+     *   new table
+     *
+     * @return a table with the values of @c other
+     *
+     * @sa static_trig_table()
+     */
+    static trig_table view_of(trig_table const &other) noexcept {
+        return trig_table{other._cos, other._sin, other.max_theta};
+    }
+
     /**
      * Get the cosine-sine pair for the given angle.  @c theta must be
      * in [0, <code>max_theta</code>).
@@ -71,12 +145,170 @@ class trig_table {
      *
      * @see max_theta
      */
-    const cossin_t &operator[](std::size_t theta) const {
+    cossin_t operator[](std::size_t theta) const {
         assert(theta < max_theta);
-        return _data[theta];
+        return cossin_t{_cos[theta], _sin[theta]};
+    }
+
+    /**
+     * @brief Get the array of cosine values.
+     *
+     * The array has @ref max_theta elements and is aligned to @ref
+     * alignment bytes.
+     *
+     * @return a pointer to the first cosine
+     */
+    double const *cos() const noexcept {
+        return _cos;
+    }
+
+    /**
+     * @brief Get the array of sine values.
+     *
+     * The array has @ref max_theta elements and is aligned to @ref
+     * alignment bytes.
+     *
+     * @return a pointer to the first sine
+     */
+    double const *sin() const noexcept {
+        return _sin;
+    }
+};
+
+/**
+ * @brief Get the table for a number of parts fixed at compile time.
+ *
+ * The table is built on first use (thread-safely) and kept until the
+ * program exits, so every accumulator constructed from the same @ref
+ * static_parameters shares one copy of its values; see @ref
+ * trig_table::view_of().
+ *
+ * The values are computed with @c std::sin and @c std::cos, as for
+ * any other table, rather than at compile time, so that the votes are
+ * the same as with a table built at run time.
+ *
+ * @tparam MaxTheta parts per semiturn
+ *
+ * @return the table
+ */
+template <std::size_t MaxTheta>
+trig_table const &static_trig_table() {
+    static trig_table const table{MaxTheta};
+    return table;
+}
+
+/**
+ * @brief A precomputed table of scaled, fixed-point cosine and sine
+ * values.
+ *
+ * The table folds the rho scale factor and the rho offset of an
+ * accumulator into 32-bit integers so that the scaled rho value of a
+ * point can be computed as
+ *
+ * @f[
+ * \rho = (x\cdot C_\theta + y\cdot S_\theta + O) \gg F
+ * @f]
+ *
+ * where @f$C_\theta = \operatorname{round}(2^{e+F}\cos\theta)@f$,
+ * @f$S_\theta = \operatorname{round}(2^{e+F}\sin\theta)@f$, and
+ * @f$O@f$ is the offset plus one half, scaled by @f$2^F@f$.  Since
+ * @f$e+F=30@f$, @f$C_\theta@f$ and @f$S_\theta@f$ carry 30 fractional
+ * bits whatever @f$F@f$ is; a larger @f$F@f$ only makes room for a
+ * smaller scale factor @f$2^e@f$, not for more precision.  The
+ * result is the floating-point rho rounded to the nearest integer
+ * except when it lies within about @f$(|x|+|y|)\cdot2^{-31}@f$ of a
+ * rounding boundary, and except for exact ties, which are rounded up
+ * rather than to even.
+ *
+ * @sa fixed_point_kernel
+ */
+class fixed_trig_table {
+    /// The storage backing both arrays.
+    std::unique_ptr<std::int32_t[]> _data;
+
+    /// The number of fractional bits, @f$F@f$.
+    int _shift;
+
+    /// The scaled offset, @f$O@f$.
+    std::int64_t _offset;
+
+  public:
+    /// Number of parts per semiturn.
+    const std::size_t max_theta;
+
+    /**
+     * @brief Construct a @c fixed_trig_table.
+     *
+     * @param trig the floating-point table to convert
+     *
+     * @param rho_scale the exponent by which raw rho values are scaled
+     *
+     * @param max_rho the height of the counter matrix
+     *
+     * @throws std::invalid_argument if @c rho_scale is too large to
+     *   leave any fractional bits, or if the scaled offset would not
+     *   fit in 63 bits
+     */
+    fixed_trig_table(trig_table const &trig, int rho_scale,
+                     std::size_t max_rho)
+        : _data(new std::int32_t[2 * trig.max_theta])
+        , _shift(30 - rho_scale)
+        , max_theta(trig.max_theta) {
+        if (_shift < 1 || _shift > 62) {
+            throw std::invalid_argument{"rho_scale out of range"};
+        }
+
+        if ((max_rho >> 1) >= (std::uint64_t{1} << (62 - _shift))) {
+            throw std::invalid_argument{"max_rho out of range"};
+        }
+
+        _offset = static_cast<std::int64_t>(max_rho >> 1) << _shift;
+        _offset += std::int64_t{1} << (_shift - 1);
+
+        for (std::size_t theta = 0; theta < max_theta; ++theta) {
+            _data[theta] = std::lround(std::scalbn(trig.cos()[theta], 30));
+            _data[theta + max_theta] =
+                std::lround(std::scalbn(trig.sin()[theta], 30));
+        }
+    }
+
+    /**
+     * @brief Get the array of scaled cosine values.
+     *
+     * @return a pointer to the first of @ref max_theta values
+     */
+    std::int32_t const *cos() const noexcept {
+        return _data.get();
+    }
+
+    /**
+     * @brief Get the array of scaled sine values.
+     *
+     * @return a pointer to the first of @ref max_theta values
+     */
+    std::int32_t const *sin() const noexcept {
+        return _data.get() + max_theta;
+    }
+
+    /**
+     * @brief Get the number of fractional bits.
+     *
+     * @return the shift @f$F@f$
+     */
+    int shift() const noexcept {
+        return _shift;
+    }
+
+    /**
+     * @brief Get the scaled offset.
+     *
+     * @return the offset @f$O@f$
+     */
+    std::int64_t offset() const noexcept {
+        return _offset;
     }
 };
 
 } // namespace ppht
 
-#endif /* ppht_accumulator_hpp */
+#endif /* ppht_trig_hpp */
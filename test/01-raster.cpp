@@ -1,6 +1,7 @@
 #include <tap.hpp>
 
 #include <ppht/raster.hpp>
+#include <ppht/spill_raster.hpp>
 
 TAP_INITIALIZE;
 
@@ -41,5 +42,103 @@ int main() {
     auto const &ref = raster;
     eq(55, ref[3][2], "constant access ok");
 
+    // A tiled raster whose dimensions are not multiples of the tile
+    // size.
+
+    ppht::basic_tiled_raster<int, 4, 8> tiled{13, 21};
+
+    eq(13U, tiled.rows(), "tiled rows");
+    eq(21U, tiled.cols(), "tiled cols");
+
+    zeroed = true;
+
+    for (auto r = 0UL; r < tiled.rows(); ++r) {
+        for (auto c = 0UL; c < tiled.cols(); ++c) {
+            zeroed = zeroed && (tiled[r][c] == 0);
+        }
+    }
+
+    ok(zeroed, "tiled raster initialized to zero");
+
+    for (auto r = 0UL; r < tiled.rows(); ++r) {
+        for (auto c = 0UL; c < tiled.cols(); ++c) {
+            tiled[r][c] = static_cast<int>(r * 100 + c);
+        }
+    }
+
+    bool distinct = true;
+    auto const &tref = tiled;
+
+    for (auto r = 0UL; r < tiled.rows(); ++r) {
+        for (auto c = 0UL; c < tiled.cols(); ++c) {
+            distinct = distinct && (tref[r][c] == static_cast<int>(r * 100 + c));
+        }
+    }
+
+    ok(distinct, "tiled cells are distinct");
+
+    // A packed raster whose rows span more than one word.
+
+    ppht::packed_raster<unsigned> packed{3, 70};
+
+    eq(3U, packed.rows(), "packed rows");
+    eq(70U, packed.cols(), "packed cols");
+    eq(3U, packed.stride(), "packed stride");
+
+    zeroed = true;
+
+    for (auto r = 0UL; r < packed.rows(); ++r) {
+        for (auto c = 0UL; c < packed.cols(); ++c) {
+            zeroed = zeroed && (packed[r][c] == 0U);
+        }
+    }
+
+    ok(zeroed, "packed raster initialized to zero");
+
+    for (auto r = 0UL; r < packed.rows(); ++r) {
+        for (auto c = 0UL; c < packed.cols(); ++c) {
+            packed[r][c] = static_cast<unsigned>((r + c) % 4);
+        }
+    }
+
+    packed[1][69] = packed[0][1];
+
+    distinct = true;
+    auto const &pref = packed;
+
+    for (auto r = 0UL; r < packed.rows(); ++r) {
+        for (auto c = 0UL; c < packed.cols(); ++c) {
+            auto const expected = (r == 1 && c == 69) ? 1U : (r + c) % 4;
+            distinct = distinct && (pref[r][c] == expected);
+        }
+    }
+
+    ok(distinct, "packed cells are distinct");
+
+    eq(0x1U, pref[1].words()[2] >> 10, "packed row words");
+
+    // Counters that overflow a byte spill into the side table.
+
+    ppht::spill_raster<unsigned> spill{4, 6};
+
+    for (int i = 0; i < 600; ++i) ++spill[2][3];
+    for (int i = 0; i < 254; ++i) ++spill[1][3];
+
+    eq(600U, spill[2][3], "spilled counter");
+    eq(254U, spill[1][3], "unspilled counter");
+    eq(1U, spill.spilled_cells(), "one cell spilled");
+
+    for (int i = 0; i < 400; ++i) --spill[2][3];
+
+    auto const &sref = spill;
+
+    eq(200U, sref[2][3], "counter returned to its cell");
+    eq(0U, spill.spilled_cells(), "side table emptied");
+
+    spill[0][0] = 70000U;
+    eq(70000U, sref[0][0], "assigned large value");
+    spill[0][0] = 0U;
+    eq(0U, spill.spilled_cells(), "assigned zero");
+
     return test_status();
 }
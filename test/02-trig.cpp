@@ -1,5 +1,7 @@
 #include <cmath>
+#include <cstdint>
 #include <ostream>
+#include <stdexcept>
 #include <utility>
 
 #include <tap.hpp>
@@ -33,7 +35,7 @@ bool eq_pair(A &&a, B &&b, double tolerance) {
 int main() {
     using namespace tap;
 
-    test_plan plan{12};
+    test_plan plan{18};
 
     ppht::trig_table trig{1024};
 
@@ -66,6 +68,55 @@ int main() {
     ok(eq_pair(std::make_pair(0.92387953, 0.38268343), t2[1], 1E-6),
        "lo-res");
 
+    auto const address = [](double const *p) {
+        return reinterpret_cast<std::uintptr_t>(p);
+    };
+
+    eq(0U, address(trig.cos()) % ppht::trig_table::alignment,
+       "cosines aligned");
+    eq(0U, address(trig.sin()) % ppht::trig_table::alignment,
+       "sines aligned");
+
+    bool same = true;
+
+    for (std::size_t theta = 0; theta < trig.max_theta; ++theta) {
+        same = same && trig.cos()[theta] == trig[theta].first
+                    && trig.sin()[theta] == trig[theta].second;
+    }
+
+    ok(same, "arrays match pairs");
+
+    ppht::fixed_trig_table fixed{trig, 0, 801};
+
+    same = true;
+
+    for (std::size_t theta = 0; theta < trig.max_theta; ++theta) {
+        auto const c = std::scalbn(fixed.cos()[theta], -30);
+        auto const s = std::scalbn(fixed.sin()[theta], -30);
+        same = same && eq_pair(trig[theta], std::make_pair(c, s), 1E-9);
+    }
+
+    ok(same, "fixed-point values match");
+
+    // With 60 fractional bits the offset of a 1025-row matrix would
+    // overflow 63 bits.
+
+    try {
+        ppht::fixed_trig_table{trig, -30, 1025};
+        fail("offset overflow detected");
+    }
+    catch (std::invalid_argument const &) {
+        pass("offset overflow detected");
+    }
+
+    try {
+        ppht::fixed_trig_table{trig, -30, 7};
+        pass("largest offset accepted");
+    }
+    catch (std::invalid_argument const &) {
+        fail("largest offset accepted");
+    }
+
     try {
         ppht::trig_table{91};
         fail("exception thrown");
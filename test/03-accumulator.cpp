@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <numeric>
 #include <ostream>
@@ -34,9 +35,14 @@ static inline ostream &operator<<(ostream &o, vector<T> const &v) {
 
 } // namespace std
 
+#include <ppht.hpp>
 #include <ppht/accumulator.hpp>
+#include <ppht/spill_raster.hpp>
 #include <ppht/types.hpp>
 
+#include "image-01.hpp"
+#include "load-image.hpp"
+
 using seed_t = std::random_device::result_type;
 
 void test_rho_scaling() {
@@ -164,10 +170,329 @@ void test_unvoting(seed_t seed) {
     }
 }
 
+void test_tiled(seed_t seed) {
+    using namespace tap;
+
+    using tiled = ppht::accumulator<std::uint16_t, ppht::tiled_raster>;
+
+    auto param = ppht::parameters{}.set_max_theta(1024);
+
+    ppht::accumulator<> acc1{240, 320, param, seed};
+    tiled acc2{240, 320, param, seed};
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, 319};
+    std::uniform_int_distribution<long> y{0, 239};
+
+    bool same = true;
+    unsigned triggered = 0;
+
+    for (int i = 0; i < 1000 && same; ++i) {
+        ppht::point_t p = (i % 2) ? ppht::point_t{x(urbg), y(urbg)}
+                                  : ppht::point_t{i / 5, i / 10 + 5};
+
+        ppht::segment_t s1, s2;
+
+        bool r1 = acc1.vote(p, s1);
+        bool r2 = acc2.vote(p, s2);
+
+        same = same && r1 == r2 && (!r1 || s1 == s2);
+
+        if (r1) ++triggered;
+    }
+
+    ok(same && triggered > 0, "tiled counters vote identically");
+
+    try {
+        acc2.unvote(ppht::point_t{0, 5});
+        pass("tiled counters unvote");
+    }
+    catch (...) {
+        fail("tiled counters unvote");
+    }
+}
+
+/// Exposes the internals of an accumulator.
+struct probe : ppht::accumulator<> {
+    using ppht::accumulator<>::accumulator;
+    using ppht::accumulator<>::counters;
+    using ppht::accumulator<>::saturated;
+    using ppht::accumulator<>::significant;
+    using ppht::accumulator<>::locate;
+    using ppht::accumulator<>::candidates;
+    using ppht::accumulator<>::conclude;
+    using ppht::accumulator<>::kernel;
+    using ppht::accumulator<>::trig;
+};
+
+void test_ties(seed_t seed) {
+    using namespace tap;
+
+    auto const param =
+        ppht::parameters{}.set_max_theta(1024).set_min_trigger_points(2);
+
+    ppht::point_t const p{50, 50};
+    std::size_t const max_theta = 1024;
+
+    // Give the cells of the sinusoid of p in some columns the same
+    // count, as if tied votes had been tallied.  The candidates are
+    // collected in order of theta, as tally() collected them before
+    // the search moved into conclude().
+
+    auto const tie = [&](probe &acc,
+                         std::vector<std::size_t> const &columns) {
+        acc.locate(p);
+
+        auto &&counters = acc.counters();
+
+        for (std::size_t theta = 0; theta < max_theta; ++theta) {
+            long r;
+            acc.kernel()(acc.trig(), p, theta, theta + 1, &r);
+            if (r < 0 || r >= static_cast<long>(counters.rows())) continue;
+
+            bool const tied = std::find(columns.begin(), columns.end(),
+                                        theta) != columns.end();
+            counters[r][theta] = tied ? 5 : 1;
+        }
+    };
+
+    auto const thetas = [](std::vector<std::pair<std::size_t, double>> &v) {
+        std::vector<std::size_t> result;
+        for (auto &&c : v) result.push_back(c.first);
+        return result;
+    };
+
+    ppht::null_observer observer;
+
+    {
+        // A cluster across the last and the first column.
+
+        probe acc{100, 100, param, seed};
+        tie(acc, {1022, 1023, 0, 1, 2});
+
+        eq(std::vector<std::size_t>{0, 1, 2, 1022, 1023},
+           thetas(acc.candidates(5, 0, max_theta)),
+           "candidates in order of theta");
+        eq(std::vector<std::size_t>{0, 1, 2, 1022, 1023},
+           thetas(acc.candidates(5, 1020, 8)),
+           "wrapped window in order of theta");
+
+        ppht::segment_t segment;
+
+        ok(acc.conclude(5, segment, observer), "wrapped cluster accepted");
+        eq(ppht::segment_t{{50, 0}, {50, 99}}, segment,
+           "wrapped cluster at theta 0");
+    }
+
+    {
+        // The median of an even cluster is the later middle column.
+
+        probe acc{100, 100, param, seed};
+        tie(acc, {510, 511, 512, 513});
+
+        ppht::segment_t segment;
+
+        ok(acc.conclude(5, segment, observer), "cluster accepted");
+        eq(ppht::segment_t{{0, 50}, {99, 50}}, segment,
+           "cluster at its median");
+    }
+
+    {
+        probe acc{100, 100, param, seed};
+        tie(acc, {100, 300});
+
+        ppht::segment_t segment;
+
+        ok(!acc.conclude(5, segment, observer), "broken cluster rejected");
+    }
+}
+
+void test_significance(seed_t seed) {
+    using namespace tap;
+
+    auto const param = ppht::parameters{}.set_max_theta(64);
+
+    probe acc{20, 20, param, seed};
+
+    double const max_rho = acc.counters().rows();
+    double const log_threshold = std::log(param.threshold);
+
+    // Every vote count from zero to well past the upper end of the
+    // interval, so both of its endpoints are crossed.
+
+    bool same = true;
+    std::size_t crossings = 0;
+
+    for (std::uint16_t n = 0; n <= 40; ++n) {
+        bool previous = true;
+
+        auto const last = static_cast<std::size_t>((2 * n + 80) * max_rho);
+
+        for (std::size_t votes = 0; votes <= last; ++votes) {
+            double const lambda = votes / max_rho;
+            double const lnp =
+                n * std::log(lambda) - std::lgamma(n + 1) - lambda;
+
+            bool const expected = !(lnp >= log_threshold);
+
+            same = same && acc.significant(n, votes) == expected;
+            crossings += expected != previous;
+            previous = expected;
+        }
+    }
+
+    ok(same, "significant() matches the log-probability");
+    eq(2U * 41, crossings, "both endpoints crossed for every count");
+}
+
+/// Exposes the counters of a spilling accumulator.
+struct spill : ppht::accumulator<std::uint16_t, ppht::spill_raster> {
+    using ppht::accumulator<std::uint16_t, ppht::spill_raster>::accumulator;
+    using ppht::accumulator<std::uint16_t, ppht::spill_raster>::counters;
+};
+
+void test_spill(seed_t seed) {
+    using namespace tap;
+
+    auto param = ppht::parameters{}.set_max_theta(1024);
+
+    ppht::accumulator<> acc1{240, 320, param, seed};
+    spill acc2{240, 320, param, seed};
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, 319};
+    std::uniform_int_distribution<long> y{0, 239};
+
+    bool same = true;
+
+    // A line of 300 points overflows the eight-bit cells.
+
+    for (int i = 0; i < 900 && same; ++i) {
+        ppht::point_t p = (i % 3) ? ppht::point_t{x(urbg), y(urbg)}
+                                  : ppht::point_t{i / 3, 50};
+
+        ppht::segment_t s1, s2;
+
+        bool r1 = acc1.vote(p, s1);
+        bool r2 = acc2.vote(p, s2);
+
+        same = same && r1 == r2 && (!r1 || s1 == s2);
+    }
+
+    ok(same, "spilling counters vote identically");
+    gt(acc2.counters().spilled_cells(), 0U, "counters spilled");
+
+    try {
+        for (int i = 0; i < 300; ++i) acc2.unvote(ppht::point_t{i, 50});
+        pass("spilling counters unvote");
+    }
+    catch (...) {
+        fail("spilling counters unvote");
+    }
+
+    eq(0U, acc2.counters().spilled_cells(), "side table emptied");
+}
+
+
+void test_reset(seed_t seed) {
+    using namespace tap;
+
+    auto param = ppht::parameters{}.set_max_theta(1024);
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, 319};
+    std::uniform_int_distribution<long> y{0, 239};
+
+    std::vector<ppht::point_t> points;
+
+    for (int i = 0; i < 1000; ++i) {
+        points.push_back((i % 2) ? ppht::point_t{x(urbg), y(urbg)}
+                                 : ppht::point_t{i / 5, i / 10 + 5});
+    }
+
+    auto same_votes = [&](probe &acc) {
+        ppht::accumulator<> fresh{240, 320, param, seed};
+
+        acc.seed(seed);
+
+        bool same = true;
+
+        for (auto &&p : points) {
+            ppht::segment_t s1, s2;
+
+            bool r1 = fresh.vote(p, s1);
+            bool r2 = acc.vote(p, s2);
+
+            same = same && r1 == r2 && (!r1 || s1 == s2);
+        }
+
+        return same;
+    };
+
+    probe acc{240, 320, param, seed};
+
+    // A few votes are cleared one sinusoid at a time, many votes by
+    // clearing the whole matrix.
+
+    for (int i = 0; i < 20; ++i) {
+        ppht::segment_t s;
+        acc.vote(points[i], s);
+    }
+
+    acc.unvote(points[0]);
+
+    ok(!acc.saturated(), "few votes cleared sparsely");
+
+    acc.reset();
+
+    ok(same_votes(acc), "sparse reset clears the counters");
+    ok(acc.saturated(), "many votes cleared in full");
+
+    acc.reset();
+
+    ok(same_votes(acc), "full reset clears the counters");
+
+    // Only the votes in effect count.
+
+    acc.reset();
+
+    for (auto &&p : points) {
+        ppht::segment_t s;
+        acc.vote(p, s);
+        acc.unvote(p);
+    }
+
+    ok(!acc.saturated(), "withdrawn votes forgotten");
+
+    // After a run, most of the pixels have been consumed.
+
+    probe run{image_01_height, image_01_width, ppht::parameters{}, seed};
+    ppht::scan_buffer buffer;
+    std::vector<ppht::segment_t> segments;
+
+    auto state =
+        load_image(image_01_height, image_01_width, image_01_bits, seed);
+    ppht::find_segments(state, run, ppht::parameters{}, segments, buffer);
+
+    ok(!segments.empty() && !run.saturated(),
+       "sparse reset after find_segments");
+
+    run.reset();
+    run.seed(seed);
+
+    std::vector<ppht::segment_t> again;
+
+    auto state2 =
+        load_image(image_01_height, image_01_width, image_01_bits, seed);
+    ppht::find_segments(state2, run, ppht::parameters{}, again, buffer);
+
+    ok(again == segments, "same segments after a sparse reset");
+}
+
 int main() {
     using namespace tap;
 
-    test_plan plan{19};
+    test_plan plan{41};
 
     // Make the test deterministic
     seed_t const seed = 696408486U;
@@ -178,6 +503,11 @@ int main() {
     test_intersection(seed);
     test_voting(seed);
     test_unvoting(seed);
+    test_tiled(seed);
+    test_spill(seed);
+    test_reset(seed);
+    test_significance(seed);
+    test_ties(seed);
 
     return test_status();
 }
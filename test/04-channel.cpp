@@ -6,6 +6,7 @@ TAP_INITIALIZE;
 
 #include <cstdlib>
 #include <random>
+#include <vector>
 
 namespace std {
 
@@ -25,7 +26,7 @@ static inline ostream &operator<<(ostream &o,
 int main() {
     using namespace tap;
 
-    test_plan plan(85);
+    test_plan plan(86);
 
     ppht::segment_t segment;
 
@@ -205,5 +206,28 @@ int main() {
         result->advance(p_new);
     }
 
+    // for_each visits the same points as the iterators
+
+    std::default_random_engine urbg{696408486U};
+    std::uniform_int_distribution<long> coord{-20, 20};
+
+    bool same = true;
+
+    for (int i = 0; i < 200; ++i) {
+        ppht::channel random_channel{{{coord(urbg), coord(urbg)},
+                                      {coord(urbg), coord(urbg)}}};
+
+        std::vector<ppht::point_t> expected{random_channel.begin(),
+                                            random_channel.end()};
+        std::vector<ppht::point_t> actual;
+
+        random_channel.for_each(
+            [&](ppht::point_t const &p) { actual.push_back(p); });
+
+        same = same && expected == actual;
+    }
+
+    ok(same, "for_each matches iteration");
+
     return test_status();
 }
@@ -4,7 +4,9 @@ TAP_INITIALIZE;
 
 #include <ppht/point_set.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <vector>
 
 namespace std {
@@ -84,5 +86,20 @@ int main() {
     eq(ppht::point_t{6,6}, *(b++), "point 4");
     ok(b == e, "iterator done");
 
+    // Points arriving out of order are sorted and deduplicated.
+
+    ppht::point_set reverse;
+
+    reverse.add_point({6,6}, std::vector<ppht::point_t>{{6,6}, {7,7}});
+    reverse.add_point({5,5}, std::vector<ppht::point_t>{{5,5}, {6,6}});
+    reverse.add_point({4,4}, std::vector<ppht::point_t>{{3,3}, {5,5}});
+
+    eq(4, std::distance(reverse.begin(), reverse.end()), "duplicates removed");
+    ok(std::is_sorted(reverse.begin(), reverse.end()), "points sorted");
+
+    reverse.clear();
+
+    ok(reverse.empty(), "cleared");
+
     return test_status();
 }
@@ -5,6 +5,7 @@ TAP_INITIALIZE;
 
 #include <ppht/state.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -52,6 +53,31 @@ int main() {
 
     eq(ppht::status_t::done, state.status({3, 2}), "marked as done");
 
+    // Stale entries are skipped and every pending pixel is drawn once.
+
+    ppht::state<> grid(10, 10, 696408486U);
+
+    for (p[1] = 0; p[1] < 10; ++p[1]) {
+        for (p[0] = 0; p[0] < 10; ++p[0]) grid.mark_pending(p);
+    }
+
+    grid.mark_pending({3, 3});
+
+    for (p[0] = 0; p[0] < 10; ++p[0]) grid.mark_done({p[0], 4});
+
+    std::vector<ppht::point_t> drawn;
+
+    while (grid.next(p)) drawn.push_back(p);
+
+    std::sort(drawn.begin(), drawn.end());
+
+    eq(90, drawn.size(), "all pending pixels drawn");
+    ok(std::adjacent_find(drawn.begin(), drawn.end()) == drawn.end(),
+       "no pixel drawn twice");
+    ok(std::none_of(drawn.begin(), drawn.end(),
+                    [](auto &&q) { return q[1] == 4; }),
+       "stale pixels skipped");
+
     auto found = ppht::find_offsets({{0, 0}, {4, 4}}, 0);
     eq(1, found.size(), "one point");
     eq(ppht::point_t(0L, 0L), *found.begin(), "zero offset");
@@ -67,5 +93,29 @@ int main() {
     ++iter;
     eq(ppht::point_t(1, -1), *iter, "pos offset");
 
+    // Two runs along a row: the scan keeps the first of the two
+    // longest, and a reused buffer gives the same result.
+
+    ppht::state<> row(3, 20);
+
+    for (long x : {1, 2, 3, 4, 9, 10, 11, 12, 17}) row.mark_pending({x, 1});
+
+    ppht::segment_t const channel{{0, 1}, {19, 1}};
+
+    auto by_value = ppht::scan(row, channel, 1, 1);
+
+    eq(ppht::segment_t({1, 1}, {4, 1}), by_value.segment(), "first longest");
+
+    ppht::scan_buffer buffer;
+
+    ppht::scan(row, {{0, 0}, {19, 0}}, 1, 1, buffer);
+
+    auto const &buffered = ppht::scan(row, channel, 1, 1, buffer);
+
+    eq(by_value.segment(), buffered.segment(), "buffered scan");
+    ok(std::equal(by_value.begin(), by_value.end(), buffered.begin(),
+                  buffered.end()),
+       "buffered scan points");
+
     return test_status();
 }
@@ -7,6 +7,9 @@ TAP_INITIALIZE;
 #include "image-01.hpp"
 #include "image-02.hpp"
 
+#include <chrono>
+#include <random>
+
 namespace std {
 
 template <class T>
@@ -68,9 +71,11 @@ restart:
     return std::make_pair(end1, end2);
 }
 
-ppht::state<> _load_image(std::size_t rows, std::size_t cols,
-                          std::uint8_t *data) {
-    ppht::state<> state{rows, cols};
+template <template <class> class Raster = ppht::raster>
+ppht::state<Raster> _load_image(std::size_t rows, std::size_t cols,
+                                std::uint8_t *data,
+                                unsigned seed = std::random_device{}()) {
+    ppht::state<Raster> state{rows, cols, seed};
 
     std::size_t bytes_per_row = (cols + 7) >> 3;
 
@@ -170,5 +175,98 @@ int main() {
         diag("unexpected: ", expected);
     }
 
+    // A packed state raster gives the same result as the default one.
+
+    auto const seed = 696408486U;
+
+    auto unpacked = find_segments(
+        _load_image(image_02_height, image_02_width, image_02_bits, seed),
+        parameters{}, seed);
+    auto packed = find_segments(
+        _load_image<packed_raster>(image_02_height, image_02_width,
+                                   image_02_bits, seed),
+        parameters{}, seed);
+
+    ok(unpacked == packed, "packed state raster");
+
+    // Streaming the segments and post-processing them gives the same
+    // result as find_segments().
+
+    std::vector<segment_t> streamed;
+
+    auto const drained = for_each_segment(
+        _load_image(image_02_height, image_02_width, image_02_bits, seed),
+        [&](segment_t const &segment) {
+            streamed.push_back(segment);
+            return true;
+        },
+        parameters{}, seed);
+
+    ok(drained, "stream drained");
+
+    streamed.erase(postprocess(streamed.begin(), streamed.end(),
+                               parameters{}.channel_width >> 1),
+                   streamed.end());
+
+    ok(streamed == unpacked, "streamed segments");
+
+    // Stopping after the first segment leaves pixels pending.
+
+    auto stopped_state =
+        _load_image(image_02_height, image_02_width, image_02_bits, seed);
+
+    int calls = 0;
+
+    auto const stopped = for_each_segment(
+        stopped_state,
+        [&](segment_t const &) { return ++calls < 1; },
+        parameters{}, seed);
+
+    ok(!stopped, "stream stopped");
+    eq(1, calls, "one segment emitted");
+
+    point_t next;
+    ok(stopped_state.next(next), "pixels left pending");
+
+    // A vote budget stops the search; a generous one changes nothing.
+
+    auto budget_state =
+        _load_image(image_02_height, image_02_width, image_02_bits, seed);
+
+    auto const budgeted = find_segments(
+        budget_state, parameters{}.set_max_votes(2), seed);
+
+    ok(budgeted.empty(), "vote budget spent");
+    ok(budget_state.next(next), "pixels left after vote budget");
+
+    auto const generous = find_segments(
+        _load_image(image_02_height, image_02_width, image_02_bits, seed),
+        parameters{}.set_max_votes(1000000), seed);
+
+    ok(generous == unpacked, "generous vote budget");
+
+    {
+        // A budget of exactly one vote per pixel is not spent.
+
+        state<> exact{10, 10, seed};
+
+        exact.mark_pending({1, 1});
+        exact.mark_pending({5, 2});
+        exact.mark_pending({8, 7});
+
+        auto const finished = for_each_segment<state<> &>(
+            exact, [](segment_t const &) { return true; },
+            parameters{}.set_max_votes(3), seed);
+
+        ok(finished, "vote budget equal to the pixel count");
+    }
+
+    auto const timed = for_each_segment(
+        _load_image(image_02_height, image_02_width, image_02_bits, seed),
+        [](segment_t const &) { return true; },
+        parameters{}.set_time_budget(std::chrono::microseconds{1}), seed);
+
+    ok(!timed, "time budget spent");
+
     return test_status();
 }
@@ -4,7 +4,10 @@ TAP_INITIALIZE;
 
 #include <ppht/postprocess.hpp>
 
+#include <algorithm>
 #include <random>
+#include <utility>
+#include <vector>
 
 namespace std {
 
@@ -51,6 +54,20 @@ int main() {
 
     test_plan plan;
 
+    {
+        std::vector<std::pair<ppht::point_t, int>> points{
+            {{0, 0}, 0}, {{3, 4}, 1}, {{10, 0}, 2}, {{-2, 2}, 3}};
+
+        auto found =
+            ppht::find_nearest(points.begin(), points.end(), {0, 0}, 5);
+
+        std::vector<int> ids;
+        for (auto &&q : found) ids.push_back(q.second);
+        std::sort(ids.begin(), ids.end());
+
+        eq(std::vector<int>{0, 1, 3}, ids, "find_nearest");
+    }
+
     std::vector<ppht::segment_t> segments;
 
     segments.push_back({{0, 0}, {50, 1}});
@@ -107,5 +124,38 @@ int main() {
         diag(segments);
     }
 
+    // A long chain of pieces, some reversed and some across the
+    // origin, collapses into one segment; a parallel chain two limits
+    // away stays separate.
+
+    segments.clear();
+
+    for (long x = -300; x < 300; x += 20) {
+        ppht::point_t a{x, 5}, b{x + 18, 5};
+        ppht::point_t c{x, 11}, d{x + 18, 11};
+
+        if (x % 40) std::swap(a, b);
+
+        segments.emplace_back(a, b);
+        segments.emplace_back(c, d);
+    }
+
+    std::shuffle(segments.begin(), segments.end(), urbg);
+
+    end = ppht::postprocess(segments.begin(), segments.end(), 3);
+    segments.erase(end, segments.end());
+
+    if (!eq(2, segments.size())) {
+        diag(segments);
+    }
+    else {
+        auto const length = [](ppht::segment_t const &s) {
+            return (s.second - s.first).length_squared();
+        };
+
+        eq(598 * 598, length(segments[0]), "first chain merged");
+        eq(598 * 598, length(segments[1]), "second chain merged");
+    }
+
     return test_status();
 }
@@ -0,0 +1,169 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht/accumulator.hpp>
+#include <ppht/kernel.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace std {
+
+template <class F, class S>
+static inline ostream &operator<<(ostream &o, const pair<F, S> &p) {
+    return o << '(' << p.first << ", " << p.second << ')';
+}
+
+} // namespace std
+
+using seed_t = std::random_device::result_type;
+
+template <class Kernel>
+std::vector<long> rho_values(std::size_t rows, std::size_t cols,
+                             std::size_t max_theta, ppht::point_t const &p) {
+    using accumulator = ppht::accumulator<>;
+
+    auto const info = accumulator::rho_info(rows, cols, max_theta);
+
+    ppht::trig_table trig{max_theta};
+    Kernel kernel{trig, info.second, info.first};
+
+    std::vector<long> result(max_theta);
+
+    // Use an odd split so the vector paths must handle a tail.
+
+    auto const split = max_theta / 3;
+
+    kernel(trig, p, 0, split, result.data());
+    kernel(trig, p, split, max_theta, result.data() + split);
+
+    return result;
+}
+
+void test_kernel(seed_t seed, std::size_t rows, std::size_t cols,
+                 std::size_t max_theta) {
+    using namespace tap;
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, static_cast<long>(cols) - 1};
+    std::uniform_int_distribution<long> y{0, static_cast<long>(rows) - 1};
+
+    bool same = true;
+
+    for (int i = 0; i < 200 && same; ++i) {
+        ppht::point_t p{x(urbg), y(urbg)};
+
+        auto expected = rho_values<ppht::scalar_kernel>(rows, cols,
+                                                        max_theta, p);
+        auto actual = rho_values<ppht::simd_kernel>(rows, cols,
+                                                    max_theta, p);
+
+        if (expected != actual) {
+            diag("mismatch for point ", p);
+            same = false;
+        }
+    }
+
+    ok(same, "simd kernel matches scalar kernel");
+}
+
+void test_fixed_point_kernel(seed_t seed, std::size_t rows, std::size_t cols,
+                             std::size_t max_theta) {
+    using namespace tap;
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, static_cast<long>(cols) - 1};
+    std::uniform_int_distribution<long> y{0, static_cast<long>(rows) - 1};
+
+    std::size_t total = 0, differ = 0;
+    long worst = 0;
+
+    for (int i = 0; i < 200; ++i) {
+        ppht::point_t p{x(urbg), y(urbg)};
+
+        auto expected = rho_values<ppht::scalar_kernel>(rows, cols,
+                                                        max_theta, p);
+        auto actual = rho_values<ppht::fixed_point_kernel>(rows, cols,
+                                                           max_theta, p);
+
+        for (std::size_t theta = 0; theta < max_theta; ++theta) {
+            auto const d = std::abs(expected[theta] - actual[theta]);
+            if (d != 0) ++differ;
+            worst = std::max(worst, d);
+            ++total;
+        }
+    }
+
+    if (!ok(worst <= 1 && differ * 1000 < total,
+            "fixed-point kernel approximates scalar kernel")) {
+        diag(differ, " of ", total, " differ, by at most ", worst);
+    }
+}
+
+void test_voting(seed_t seed) {
+    using namespace tap;
+
+    using scalar = ppht::accumulator<std::uint16_t, ppht::raster,
+                                     ppht::scalar_kernel>;
+    using simd = ppht::accumulator<std::uint16_t, ppht::raster,
+                                   ppht::simd_kernel>;
+
+    auto param = ppht::parameters{}.set_max_theta(1024);
+
+    scalar acc1{240, 320, param, seed};
+    simd acc2{240, 320, param, seed};
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, 319};
+    std::uniform_int_distribution<long> y{0, 239};
+
+    bool same = true;
+    unsigned triggered = 0;
+
+    for (int i = 0; i < 2000 && same; ++i) {
+        // Mix random noise with a line so that scans are triggered.
+
+        ppht::point_t p = (i % 2) ? ppht::point_t{x(urbg), y(urbg)}
+                                  : ppht::point_t{i / 10, i / 20 + 5};
+
+        ppht::segment_t s1, s2;
+
+        bool r1 = acc1.vote(p, s1);
+        bool r2 = acc2.vote(p, s2);
+
+        if (r1 != r2 || (r1 && s1 != s2)) {
+            diag("divergence at vote ", i);
+            same = false;
+        }
+
+        if (r1) ++triggered;
+    }
+
+    ok(same, "simd accumulator matches scalar accumulator");
+    gt(triggered, 0U, "scans were triggered");
+}
+
+int main() {
+    using namespace tap;
+
+    test_plan plan{8};
+
+    // Make the test deterministic
+    seed_t const seed = 696408486U;
+
+    diag("random seed is ", seed);
+
+    test_kernel(seed, 10, 10, 1024);
+    test_kernel(seed, 240, 320, 1026);
+    test_kernel(seed, 4000, 3000, 2048);
+    test_fixed_point_kernel(seed, 10, 10, 1024);
+    test_fixed_point_kernel(seed, 240, 320, 1026);
+    test_fixed_point_kernel(seed, 4000, 3000, 2048);
+    test_voting(seed);
+
+    return test_status();
+}
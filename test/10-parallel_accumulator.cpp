@@ -0,0 +1,184 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/parallel_accumulator.hpp>
+#include <ppht/thread_pool.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using seed_t = std::random_device::result_type;
+
+void test_pool() {
+    using namespace tap;
+
+    ppht::thread_pool pool{4};
+
+    eq(4U, pool.size(), "pool size");
+
+    std::vector<std::atomic<int>> hits(1000);
+
+    for (int pass = 0; pass < 100; ++pass) {
+        pool.parallel_for(hits.size(), [&](std::size_t i) { ++hits[i]; });
+    }
+
+    bool all = true;
+    for (auto &&h : hits) all = all && h == 100;
+
+    ok(all, "every index visited once per loop");
+
+    try {
+        pool.parallel_for(10, [](std::size_t i) {
+            if (i == 7) throw std::runtime_error{"seven"};
+        });
+        fail("exception propagated");
+    }
+    catch (std::runtime_error const &) {
+        pass("exception propagated");
+    }
+
+    std::atomic<int> count{0};
+    pool.parallel_for(3, [&](std::size_t) { ++count; });
+    eq(3, count.load(), "pool usable after exception");
+}
+
+void test_voting(seed_t seed) {
+    using namespace tap;
+
+    auto param = ppht::parameters{}.set_max_theta(1024);
+
+    ppht::accumulator<> acc1{240, 320, param, seed};
+    ppht::parallel_accumulator<> acc2{240, 320, param, seed, 3};
+
+    eq(3U, acc2.shards(), "shard count");
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, 319};
+    std::uniform_int_distribution<long> y{0, 239};
+
+    bool same = true;
+    unsigned triggered = 0;
+
+    std::vector<ppht::point_t> points;
+
+    for (int i = 0; i < 1000 && same; ++i) {
+        ppht::point_t p = (i % 2) ? ppht::point_t{x(urbg), y(urbg)}
+                                  : ppht::point_t{i / 5, i / 10 + 5};
+
+        ppht::segment_t s1, s2;
+
+        bool r1 = acc1.vote(p, s1);
+        bool r2 = acc2.vote(p, s2);
+
+        same = same && r1 == r2 && (!r1 || s1 == s2);
+
+        if (r1) ++triggered;
+
+        points.push_back(p);
+
+        // Remove some of the points to exercise unvote.
+
+        if (i % 3 == 2) {
+            acc1.unvote(points[i / 2]);
+            acc2.unvote(points[i / 2]);
+        }
+    }
+
+    ok(same && triggered > 0, "parallel accumulator votes identically");
+
+    try {
+        acc2.unvote(ppht::point_t{-1000, -1000});
+        fail("unvote error propagated");
+    }
+    catch (std::logic_error const &) {
+        pass("unvote error propagated");
+    }
+}
+
+void test_oriented(seed_t seed) {
+    using namespace tap;
+
+    auto param = ppht::parameters{}.set_max_theta(1024);
+
+    ppht::accumulator<> acc1{240, 320, param, seed};
+    ppht::parallel_accumulator<> acc2{240, 320, param, seed, 3};
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> x{0, 319};
+    std::uniform_int_distribution<long> y{0, 239};
+
+    bool same = true;
+    unsigned triggered = 0;
+
+    for (int i = 0; i < 400 && same; ++i) {
+        // Alternate oriented votes along a vertical line with plain
+        // votes of noise.
+
+        ppht::segment_t s1, s2;
+        bool r1, r2;
+
+        if (i % 2) {
+            ppht::point_t const p{x(urbg), y(urbg)};
+            r1 = acc1.vote(p, s1);
+            r2 = acc2.vote(p, s2);
+        }
+        else {
+            ppht::point_t const p{100, i / 2};
+            r1 = acc1.vote(p, 0.0, 0.05, s1);
+            r2 = acc2.vote(p, 0.0, 0.05, s2);
+
+            if (i % 6 == 4) {
+                acc1.unvote(p, 0.0, 0.05);
+                acc2.unvote(p, 0.0, 0.05);
+            }
+        }
+
+        same = same && r1 == r2 && (!r1 || s1 == s2);
+
+        if (r1) ++triggered;
+    }
+
+    ok(same && triggered > 0, "oriented votes identical");
+}
+
+ppht::state<> load_image(seed_t seed) {
+    return load_image(image_01_height, image_01_width, image_01_bits, seed);
+}
+
+void test_segments(seed_t seed) {
+    using namespace tap;
+
+    ppht::parameters param;
+
+    auto expected = ppht::find_segments(load_image(seed), param, seed);
+    auto actual =
+        ppht::find_segments<ppht::state<>, ppht::parallel_accumulator<>>(
+            load_image(seed), param, seed);
+
+    ok(expected == actual, "same segments as single-threaded run");
+}
+
+int main() {
+    using namespace tap;
+
+    test_plan plan{9};
+
+    // Make the test deterministic
+    seed_t const seed = 696408486U;
+
+    diag("random seed is ", seed);
+
+    test_pool();
+    test_voting(seed);
+    test_oriented(seed);
+    test_segments(seed);
+
+    return test_status();
+}
@@ -0,0 +1,137 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht/tiled.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <tuple>
+#include <vector>
+
+namespace std {
+
+template <class T>
+static inline ostream &operator <<(ostream &o, const vector<T> &v) {
+    auto b = v.begin();
+    auto e = v.end();
+
+    o << '[';
+
+    if (b != e) {
+        o << *b;
+        while (++b != e) {
+            o << ", " << *b;
+        }
+    }
+
+    return o << ']';
+}
+
+template <class F, class S>
+static inline ostream &operator <<(ostream &o, const pair<F, S> &p) {
+    return o << '(' << p.first << ", " << p.second << ')';
+}
+
+} // namespace std
+
+template <class ForwardIt, class Pred>
+std::pair<ForwardIt, ForwardIt>
+remove_pairs(ForwardIt begin1, ForwardIt end1,
+             ForwardIt begin2, ForwardIt end2,
+             Pred pred) {
+restart:
+    for (auto i = begin1; i != end1; ++i) {
+        for (auto j = begin2; j != end2; ++j) {
+            if (pred(*i, *j)) {
+                std::swap(*i, *(--end1));
+                std::swap(*j, *(--end2));
+                goto restart;
+            }
+        }
+    }
+
+    return std::make_pair(end1, end2);
+}
+
+ppht::state<> load_image() {
+    return load_image(image_01_height, image_01_width, image_01_bits);
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{8};
+
+    segment_t s{{-10, 5}, {30, 25}};
+
+    ok(clip_segment(s, {0, 0}, {20, 20}), "segment clipped");
+    eq(segment_t({0, 10}, {20, 20}), s, "clipped endpoints");
+
+    s = segment_t{{-10, 5}, {-5, 25}};
+    ok(!clip_segment(s, {0, 0}, {20, 20}), "segment outside");
+
+    ne(derive_seed(1, 0), derive_seed(1, 1), "distinct seeds");
+    eq(derive_seed(1, 7), derive_seed(1, 7), "repeatable seeds");
+
+    auto const image = load_image();
+
+    // Seams at x = 80, 160, 240 and y = 80 cut through several of the
+    // squares.
+
+    auto const tiles = tiling{}.set_tile_size(80).set_overlap(20)
+                               .set_threads(2);
+
+    auto const seed = 696408486U;
+
+    auto actual = find_segments_tiled(image, tiles, parameters{}, seed);
+    auto again = find_segments_tiled(image, tiles, parameters{}, seed);
+
+    ok(actual == again, "deterministic");
+
+    std::vector<segment_t> expected = {segment_t{{20, 20}, {100, 20}},
+                                       segment_t{{20, 20}, {20, 100}},
+                                       segment_t{{100, 20}, {100, 100}},
+                                       segment_t{{20, 100}, {100, 100}},
+                                       segment_t{{120, 20}, {200, 20}},
+                                       segment_t{{120, 20}, {120, 100}},
+                                       segment_t{{200, 20}, {200, 100}},
+                                       segment_t{{120, 100}, {200, 100}},
+                                       segment_t{{220, 20}, {300, 20}},
+                                       segment_t{{220, 20}, {220, 100}},
+                                       segment_t{{300, 20}, {300, 100}},
+                                       segment_t{{220, 100}, {300, 100}}};
+
+    static auto within = [](const point_t &p1, const point_t &p2) {
+        auto dx = static_cast<double>(p1[0]) - p2[0];
+        auto dy = static_cast<double>(p1[1]) - p2[1];
+        return dx * dx + dy * dy <= 25.0;
+    };
+
+    static auto similar = [](const segment_t &s1, const segment_t &s2) {
+        return (within(s1.first, s2.first) && within(s1.second, s2.second))
+            || (within(s1.first, s2.second) && within(s1.second, s2.first));
+    };
+
+    auto b1 = actual.begin();
+    auto e1 = actual.end();
+    auto b2 = expected.begin();
+    auto e2 = expected.end();
+
+    std::tie(e1, e2) = remove_pairs(b1, e1, b2, e2, similar);
+
+    actual.erase(e1, actual.end());
+    expected.erase(e2, expected.end());
+
+    if (!ok(actual.empty(), "no unexpected segments seen")) {
+        diag("unexpected: ", actual);
+    }
+
+    if (!ok(expected.empty(), "all expected segments seen")) {
+        diag("missing: ", expected);
+    }
+
+    return test_status();
+}
@@ -0,0 +1,143 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht/detector.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using seed_t = std::random_device::result_type;
+
+ppht::state<> load_image(seed_t seed, unsigned noise) {
+    // The noise depends on its density so that every frame can use
+    // the same seed.
+
+    ppht::state<> state{image_01_height, image_01_width, seed};
+
+    std::default_random_engine urbg{noise};
+    std::uniform_int_distribution<unsigned> dist{0, 999};
+
+    for (unsigned y = 0; y < image_01_height; ++y) {
+        for (unsigned x = 0; x < image_01_width; ++x) {
+            if (is_set(image_01_bits, image_01_width, x, y) ||
+                dist(urbg) < noise) {
+                state.mark_pending({x, y});
+            }
+        }
+    }
+
+    return state;
+}
+
+int main() {
+    using namespace tap;
+
+    test_plan plan{8};
+
+    // Make the test deterministic
+    seed_t const seed = 696408486U;
+
+    diag("random seed is ", seed);
+
+    auto const frame1 = load_image(seed, 0);
+    auto const frame2 = load_image(seed, 5);
+
+    auto const expected1 = ppht::find_segments(load_image(seed, 0),
+                                               ppht::parameters{}, seed);
+    auto const expected2 = ppht::find_segments(load_image(seed, 5),
+                                               ppht::parameters{}, seed);
+
+    ppht::detector<> detector{image_01_height, image_01_width,
+                              ppht::parameters{}, seed};
+
+    ok(detector.detect(frame1) == expected1, "first frame");
+
+    detector.seed(seed);
+    ok(detector.detect(frame2) == expected2, "second frame");
+
+    detector.seed(seed);
+    ok(detector.detect(frame1) == expected1, "first frame again");
+
+    // Feed the pixels by hand, without a frame object.
+
+    detector.reset();
+    detector.seed(seed);
+
+    ppht::point_t p;
+
+    for (p[1] = 0; p[1] < static_cast<long>(image_01_height); ++p[1]) {
+        for (p[0] = 0; p[0] < static_cast<long>(image_01_width); ++p[0]) {
+            if (frame2.status(p) == ppht::status_t::pending) {
+                detector.mark_pending(p);
+            }
+        }
+    }
+
+    ok(detector.detect() == expected2, "pixels marked directly");
+
+    gt(expected1.size(), 0U, "segments found");
+
+    // A frame stopped by the budget leaves pixels in the queue; they
+    // must not affect the next frame.
+
+    auto const budget = ppht::parameters{}.set_max_votes(30);
+
+    ppht::detector<> limited{image_01_height, image_01_width, budget, seed};
+
+    limited.detect(frame1);
+    limited.seed(seed);
+
+    ok(limited.detect(frame2) ==
+           ppht::find_segments(load_image(seed, 5), budget, seed),
+       "frame after a stopped frame");
+
+    // Once every buffer has grown to the size of the frames, a frame
+    // allocates nothing.
+
+    detector.seed(seed);
+    detector.detect(frame2);
+
+    auto const before = allocations;
+
+    detector.seed(seed);
+    detector.detect(frame2);
+
+    eq(0U, allocations - before, "no heap allocation in a frame");
+
+    try {
+        detector.detect(ppht::state<>{10, 10});
+        fail("size mismatch detected");
+    }
+    catch (std::invalid_argument const &) {
+        pass("size mismatch detected");
+    }
+
+    return test_status();
+}
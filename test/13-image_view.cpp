@@ -0,0 +1,151 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/image_view.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using seed_t = std::random_device::result_type;
+
+ppht::state<> load_image(seed_t seed) {
+    return load_image(image_01_height, image_01_width, image_01_bits, seed);
+}
+
+template <class View>
+std::vector<ppht::point_t> set_pixels(View const &view) {
+    std::vector<ppht::point_t> result;
+    view.for_each_set([&](ppht::point_t const &p) { result.push_back(p); });
+    return result;
+}
+
+template <class View>
+std::vector<ppht::point_t> set_pixels_slowly(View const &view) {
+    std::vector<ppht::point_t> result;
+
+    ppht::point_t p;
+
+    for (p[1] = 0; p[1] < static_cast<long>(view.rows()); ++p[1]) {
+        for (p[0] = 0; p[0] < static_cast<long>(view.cols()); ++p[0]) {
+            if (view.status(p) == ppht::status_t::pending) result.push_back(p);
+        }
+    }
+
+    return result;
+}
+
+struct above_128 {
+    bool operator()(std::uint8_t value) const noexcept {
+        return value > 128;
+    }
+};
+
+int main() {
+    using namespace tap;
+
+    test_plan plan{9};
+
+    // Make the test deterministic
+    seed_t const seed = 696408486U;
+
+    diag("random seed is ", seed);
+
+    auto const expected = ppht::find_segments(load_image(seed),
+                                              ppht::parameters{}, seed);
+
+    // An 8-bit copy of the image with padded rows.
+
+    std::size_t const stride = image_01_width + 13;
+    std::vector<std::uint8_t> bytes(image_01_height * stride, 0xFF);
+
+    for (unsigned y = 0; y < image_01_height; ++y) {
+        for (unsigned x = 0; x < image_01_width; ++x) {
+            bytes[y * stride + x] = is_set(image_01_bits, image_01_width, x, y)
+                                        ? 200
+                                        : (x % 3 ? 0 : 100);
+        }
+    }
+
+    ppht::byte_image_view<above_128> byte_view{bytes.data(), image_01_height,
+                                               image_01_width, stride};
+
+    ok(set_pixels(byte_view) == set_pixels_slowly(byte_view),
+       "predicate view visits set pixels");
+
+    ppht::byte_image_view<> nonzero_view{bytes.data(), image_01_height,
+                                         image_01_width, stride};
+
+    ok(set_pixels(nonzero_view) == set_pixels_slowly(nonzero_view),
+       "nonzero view visits set pixels");
+
+    auto actual = ppht::find_segments(ppht::state<>{byte_view, seed},
+                                      ppht::parameters{}, seed);
+
+    ok(expected == actual, "segments from byte view");
+
+    // The bitmap itself, least significant bit first.
+
+    ppht::bit_image_view bit_view{image_01_bits, image_01_height,
+                                  image_01_width, (image_01_width + 7) >> 3};
+
+    ok(set_pixels(bit_view) == set_pixels_slowly(bit_view),
+       "bit view visits set pixels");
+
+    actual = ppht::find_segments(ppht::state<>{bit_view, seed},
+                                 ppht::parameters{}, seed);
+
+    ok(expected == actual, "segments from bit view");
+
+    // A narrower window of the bitmap with the bits reversed, so the
+    // rows end partway through a byte.
+
+    std::vector<std::uint8_t> reversed(image_01_height * 40);
+
+    for (std::size_t i = 0; i < reversed.size(); ++i) {
+        std::uint8_t b = image_01_bits[i], r = 0;
+        for (int k = 0; k < 8; ++k) r |= ((b >> k) & 1) << (7 - k);
+        reversed[i] = r;
+    }
+
+    ppht::bit_image_view msb_view{reversed.data(), image_01_height, 301, 40,
+                                  true};
+
+    auto const msb_pixels = set_pixels(msb_view);
+
+    ok(msb_pixels == set_pixels_slowly(msb_view), "msb view visits set pixels");
+
+    bool match = true;
+
+    for (auto &&p : msb_pixels) {
+        match = match && is_set(image_01_bits, image_01_width, p[0], p[1]);
+    }
+
+    ok(match && !msb_pixels.empty(), "msb view reads the right bits");
+
+    ppht::state<> state{msb_view, seed};
+
+    eq(ppht::status_t::pending, state.status(msb_pixels.back()),
+       "state loaded from view");
+
+    // The raster constructor picks up pending cells.
+
+    ppht::raster<ppht::status_t> raster{4, 5};
+    raster[1][2] = raster[3][4] = ppht::status_t::pending;
+
+    ppht::state<> from_raster{std::move(raster), seed};
+
+    std::size_t count = 0;
+    ppht::point_t p;
+
+    while (from_raster.next(p)) ++count;
+
+    eq(2U, count, "state loaded from raster");
+
+    return test_status();
+}
@@ -0,0 +1,116 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/sparse_state.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <random>
+#include <vector>
+
+using seed_t = std::random_device::result_type;
+
+std::vector<ppht::point_t> edge_points() {
+    std::vector<ppht::point_t> result;
+
+    for (unsigned y = 0; y < image_01_height; ++y) {
+        for (unsigned x = 0; x < image_01_width; ++x) {
+            if (is_set(image_01_bits, image_01_width, x, y)) {
+                result.emplace_back(x, y);
+            }
+        }
+    }
+
+    return result;
+}
+
+int main() {
+    using namespace tap;
+
+    test_plan plan{14};
+
+    // Make the test deterministic
+    seed_t const seed = 696408486U;
+
+    diag("random seed is ", seed);
+
+    ppht::sparse_state state{100000, 100000, seed};
+
+    eq(100000U, state.rows(), "rows");
+    eq(100000U, state.cols(), "cols");
+    eq(ppht::status_t::unset, state.status({5, 7}), "initially unset");
+
+    // Enough pixels to force the table to grow.
+
+    for (long i = 0; i < 1000; ++i) state.mark_pending({i * 97, i * 89});
+
+    eq(ppht::status_t::pending, state.status({97 * 500, 89 * 500}),
+       "marked as pending");
+    eq(ppht::status_t::unset, state.status({89 * 500, 97 * 500}),
+       "others unset");
+
+    state.mark_done({0, 0});
+    eq(ppht::status_t::done, state.status({0, 0}), "marked as done");
+
+    state.mark_unset({97, 89});
+    eq(ppht::status_t::unset, state.status({97, 89}), "marked as unset");
+
+    eq(999U, state.size(), "unset pixel removed from the table");
+
+    // Removing pixels takes them out of their clusters; the rest must
+    // still be found.
+
+    {
+        ppht::sparse_state table{1000, 1000, seed};
+
+        for (long i = 0; i < 5000; ++i) table.mark_done({i % 1000, i / 1000});
+        for (long i = 0; i < 5000; i += 2) {
+            table.mark_unset({i % 1000, i / 1000});
+        }
+
+        bool found = true;
+
+        for (long i = 0; i < 5000; ++i) {
+            auto const expected =
+                i % 2 ? ppht::status_t::done : ppht::status_t::unset;
+            found = found && table.status({i % 1000, i / 1000}) == expected;
+        }
+
+        eq(2500U, table.size(), "size decremented");
+        ok(found, "remaining pixels found after removal");
+    }
+
+    std::size_t count = 0;
+    bool voted = true;
+    ppht::point_t p;
+
+    while (state.next(p)) {
+        voted = voted && state.status(p) == ppht::status_t::voted;
+        ++count;
+    }
+
+    eq(998U, count, "pending pixels drawn");
+    ok(voted, "drawn pixels marked voted");
+
+    // The whole algorithm on a list of edge points.
+
+    auto const points = edge_points();
+
+    ppht::state<> dense{image_01_height, image_01_width, seed};
+    for (auto &&q : points) dense.mark_pending(q);
+
+    auto const expected =
+        ppht::find_segments(std::move(dense), ppht::parameters{}, seed);
+    auto const actual = ppht::find_segments(
+        ppht::sparse_state{image_01_height, image_01_width, points.begin(),
+                           points.end(), seed},
+        ppht::parameters{}, seed);
+
+    gt(expected.size(), 0U, "segments found");
+    ok(expected == actual, "same segments as dense state");
+
+    return test_status();
+}
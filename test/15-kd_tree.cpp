@@ -0,0 +1,87 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht/kd-search.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using entry_t = std::pair<ppht::point_t, int>;
+
+std::vector<std::size_t> brute_force(std::vector<entry_t> const &entries,
+                                     std::vector<bool> const &erased,
+                                     ppht::point_t const &p, long limit) {
+    std::vector<std::size_t> result;
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (erased[i]) continue;
+        if ((p - entries[i].first).length_squared() <= limit * limit) {
+            result.push_back(i);
+        }
+    }
+
+    return result;
+}
+
+int main() {
+    using namespace tap;
+
+    test_plan plan{7};
+
+    std::default_random_engine urbg{696408486U};
+    std::uniform_int_distribution<long> coord{-100, 100};
+    std::uniform_int_distribution<long> radius{0, 30};
+
+    std::vector<entry_t> entries;
+
+    for (int i = 0; i < 1000; ++i) {
+        entries.emplace_back(ppht::point_t{coord(urbg), coord(urbg)}, i);
+    }
+
+    auto const copy = entries;
+
+    ppht::kd_tree<entry_t> tree{entries.begin(), entries.end()};
+
+    eq(1000U, tree.size(), "size");
+    ok(entries == copy, "input untouched");
+    eq(entries[17].second, tree[17].second, "elements in input order");
+
+    std::vector<bool> erased(entries.size());
+
+    auto const agrees = [&] {
+        for (int q = 0; q < 500; ++q) {
+            ppht::point_t p{coord(urbg), coord(urbg)};
+            auto r = radius(urbg);
+
+            std::vector<std::size_t> found;
+            tree.search(std::back_inserter(found), p, r);
+            std::sort(found.begin(), found.end());
+
+            if (found != brute_force(entries, erased, p, r)) return false;
+        }
+        return true;
+    };
+
+    ok(agrees(), "radius queries");
+
+    for (std::size_t i = 0; i < entries.size(); i += 3) {
+        tree.erase(i);
+        tree.erase(i);
+        erased[i] = true;
+    }
+
+    ok(tree.erased(3) && !tree.erased(4), "erase flags");
+    ok(agrees(), "radius queries after erase");
+
+    for (std::size_t i = 0; i < entries.size(); ++i) tree.erase(i);
+
+    std::vector<std::size_t> found;
+    tree.search(std::back_inserter(found), ppht::point_t{0, 0}, 200);
+
+    ok(found.empty(), "all erased");
+
+    return test_status();
+}
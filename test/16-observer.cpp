@@ -0,0 +1,62 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht/detector.hpp>
+
+#include "image-02.hpp"
+#include "load-image.hpp"
+
+#include <vector>
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{9};
+
+    auto const seed = 696408486U;
+
+    parameters const param;
+
+    state<> plain_state{image_02_height, image_02_width, seed};
+    mark_image(plain_state, image_02_bits);
+
+    auto const plain = find_segments(plain_state, param, seed);
+
+    state<> observed_state{image_02_height, image_02_width, seed};
+    mark_image(observed_state, image_02_bits);
+
+    accumulator<> acc{image_02_height, image_02_width, param, seed};
+    scan_buffer buffer;
+    std::vector<segment_t> observed;
+    stats_observer stats;
+
+    find_segments(observed_state, acc, param, observed, buffer, stats);
+
+    ok(plain == observed, "observing does not change the result");
+
+    gt(stats.votes, 0U, "votes counted");
+    le(stats.threshold_tests, stats.votes, "threshold tests");
+    eq(stats.scans + stats.rejected_clusters, stats.significant,
+       "significant votes scanned or rejected");
+    eq(observed.size() + stats.merges, stats.accepted_scans,
+       "accepted scans less merges");
+    le(stats.unvotes, stats.consumed_pixels, "unvoted pixels consumed");
+    gt(stats.elapsed(phase_t::voting).count(), 0, "voting timed");
+
+    // The detector passes its observer to every run.
+
+    detector<accumulator<>, raster, stats_observer> d{
+        image_02_height, image_02_width, param, seed};
+
+    mark_image(d, image_02_bits);
+    d.detect();
+
+    eq(stats.votes, d.observer().votes, "detector observer");
+
+    d.observer().clear();
+    eq(0U, d.observer().votes, "observer cleared");
+
+    return test_status();
+}
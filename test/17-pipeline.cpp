@@ -0,0 +1,77 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht/pipeline.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <algorithm>
+#include <vector>
+
+ppht::state<> load_image(unsigned seed) {
+    return load_image(image_01_height, image_01_width, image_01_bits, seed);
+}
+
+std::vector<ppht::segment_t> run(ppht::scan_pipeline &pipeline,
+                                 unsigned seed) {
+    ppht::parameters const param;
+
+    auto state = load_image(seed);
+    ppht::accumulator<> acc{state.rows(), state.cols(), param, seed};
+    ppht::scan_buffer buffer;
+    std::vector<ppht::segment_t> segments;
+
+    pipeline.find_segments(state, acc, param, segments, buffer);
+
+    return segments;
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{8};
+
+    auto const seed = 696408486U;
+
+    auto const sequential = find_segments(load_image(seed), parameters{}, seed);
+
+    scan_pipeline lag0{0};
+    eq(0U, lag0.lag(), "lag");
+    ok(run(lag0, seed) == sequential, "no lag matches find_segments");
+
+    scan_pipeline serial{8, 1};
+    scan_pipeline threaded{8, 2};
+
+    eq(1U, serial.threads(), "one thread");
+    eq(2U, scan_pipeline(8, 4).threads(), "no more than two threads");
+
+    auto const lagged = run(threaded, seed);
+
+    ok(run(serial, seed) == lagged, "independent of the number of threads");
+    ok(run(threaded, seed) == lagged, "deterministic");
+
+    // The squares of the image are found either way.
+
+    static auto within = [](const point_t &p1, const point_t &p2) {
+        auto dx = static_cast<double>(p1[0]) - p2[0];
+        auto dy = static_cast<double>(p1[1]) - p2[1];
+        return dx * dx + dy * dy <= 25.0;
+    };
+
+    auto const matched = std::all_of(
+        sequential.begin(), sequential.end(), [&](segment_t const &s) {
+            return std::any_of(lagged.begin(), lagged.end(),
+                               [&](segment_t const &t) {
+                                   return within(s.first, t.first) &&
+                                          within(s.second, t.second);
+                               });
+        });
+
+    ok(matched, "same segments found");
+    eq(sequential.size(), lagged.size(), "same number of segments");
+
+    return test_status();
+}
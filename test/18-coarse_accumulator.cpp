@@ -0,0 +1,99 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/coarse_accumulator.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+ppht::state<> load_image(unsigned seed) {
+    return load_image(image_01_height, image_01_width, image_01_bits, seed);
+}
+
+template <class Accumulator>
+std::vector<ppht::segment_t> run(Accumulator &acc, unsigned seed) {
+    auto state = load_image(seed);
+    ppht::scan_buffer buffer;
+    std::vector<ppht::segment_t> segments;
+
+    acc.reset();
+    ppht::find_segments(state, acc, ppht::parameters{}, segments, buffer);
+
+    return segments;
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{7};
+
+    auto const seed = 696408486U;
+    parameters const param;
+
+    try {
+        coarse_accumulator<> acc{image_01_height, image_01_width, param, seed,
+                                 3};
+        fail("factor must divide a quarter of max_theta");
+    }
+    catch (std::invalid_argument const &) {
+        pass("factor must divide a quarter of max_theta");
+    }
+
+    auto const sequential = find_segments(load_image(seed), param, seed);
+
+    // Without a reduction in resolution or a looser threshold, the
+    // screen finds the same candidates as the full accumulator.
+
+    coarse_accumulator<> same{image_01_height, image_01_width, param, seed,
+                              1, 1.0};
+    ok(run(same, seed) == sequential, "factor 1 matches accumulator");
+
+    coarse_accumulator<> coarse{image_01_height, image_01_width, param, seed};
+    eq(8U, coarse.factor(), "default factor");
+
+    auto const screened = run(coarse, seed);
+
+    eq(sequential.size(), screened.size(), "as many segments");
+
+    // The segments found are those of the full accumulator, give or
+    // take a few pixels at the ends.
+
+    static auto within = [](const point_t &p1, const point_t &p2) {
+        auto dx = static_cast<double>(p1[0]) - p2[0];
+        auto dy = static_cast<double>(p1[1]) - p2[1];
+        return dx * dx + dy * dy <= 25.0;
+    };
+
+    auto const matched = std::all_of(
+        sequential.begin(), sequential.end(), [&](segment_t const &s) {
+            return std::any_of(screened.begin(), screened.end(),
+                               [&](segment_t const &t) {
+                                   return within(s.first, t.first) &&
+                                          within(s.second, t.second);
+                               });
+        });
+
+    ok(matched, "same segments, near enough");
+
+    coarse.seed(seed);
+    ok(run(coarse, seed) == screened, "reset clears the log");
+
+    coarse.reset();
+
+    try {
+        coarse.unvote(point_t{5, 5});
+        fail("unvote error propagated");
+    }
+    catch (std::logic_error const &) {
+        pass("unvote error propagated");
+    }
+
+    return test_status();
+}
@@ -0,0 +1,134 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/oriented_state.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+bool bit(long x, long y) {
+    if (x < 0 || y < 0) return false;
+    if (x >= long(image_01_width) || y >= long(image_01_height)) return false;
+
+    return is_set(image_01_bits, image_01_width, x, y);
+}
+
+/// Load the image, taking the orientation of each pixel from its
+/// neighbours, or giving every pixel the same one.
+ppht::oriented_state<> load_image(unsigned seed, double tolerance,
+                                  bool fixed = false) {
+    ppht::oriented_state<> state{image_01_height, image_01_width, tolerance,
+                                 seed};
+
+    auto const quarter = 2 * std::atan2(1, 1);
+
+    for (long y = 0; y < long(image_01_height); ++y) {
+        for (long x = 0; x < long(image_01_width); ++x) {
+            if (!bit(x, y)) continue;
+
+            auto const across = bit(x - 1, y) + bit(x + 1, y);
+            auto const down = bit(x, y - 1) + bit(x, y + 1);
+
+            state.mark_pending({x, y},
+                               !fixed && across >= down ? quarter : 0.0);
+        }
+    }
+
+    return state;
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{10};
+
+    auto const seed = 696408486U;
+    parameters const param;
+
+    auto const quarter = 2 * std::atan2(1, 1);
+
+    {
+        accumulator<> acc{100, 100, param, seed};
+        segment_t segment;
+        bool found = false;
+
+        for (long x = 0; x < 100 && !found; x += 3) {
+            found = acc.vote({x, 40}, quarter, 0.05, segment);
+        }
+
+        ok(found && segment.first[1] == 40 && segment.second[1] == 40,
+           "oriented votes find a horizontal line");
+
+        acc.reset();
+        acc.vote({10, 10}, quarter, 0.05, segment);
+
+        try {
+            acc.unvote({10, 10});
+            fail("only the window is voted");
+        }
+        catch (std::logic_error const &) {
+            pass("only the window is voted");
+        }
+
+        acc.reset();
+        acc.vote({10, 10}, -quarter, 0.05, segment);
+        acc.unvote({10, 10}, 3 * quarter, 0.05);
+        pass("orientation taken modulo a semiturn");
+
+        // The window of an oriented unvote must be covered by oriented
+        // votes, even where a full vote leaves the counters nonzero.
+
+        accumulator<> fresh{100, 100, param, seed};
+
+        try {
+            fresh.unvote({10, 10}, quarter, 0.05);
+            fail("unvote before any oriented vote");
+        }
+        catch (std::logic_error const &) {
+            pass("unvote before any oriented vote");
+        }
+
+        acc.reset();
+        acc.vote({10, 10}, segment);
+
+        try {
+            acc.unvote({10, 10}, quarter, 0.05);
+            fail("unvote of an uncovered window");
+        }
+        catch (std::logic_error const &) {
+            pass("unvote of an uncovered window");
+        }
+    }
+
+    auto state = load_image(seed, 0.1);
+
+    eq(0.1, state.tolerance(), "tolerance");
+    eq(float(quarter), float(state.orientation({20, 20})), "orientation");
+
+    auto const sequential = find_segments(load_image(seed, 4.0), param, seed);
+    auto const oriented = find_segments(std::move(state), param, seed);
+
+    eq(12U, oriented.size(), "every segment found");
+    ok(oriented == sequential, "same segments as voting every angle");
+
+    // With every normal horizontal, only the vertical lines remain.
+
+    auto const vertical = find_segments(load_image(seed, 0.1, true), param, seed);
+
+    ok(!vertical.empty() &&
+           std::all_of(vertical.begin(), vertical.end(),
+                       [](segment_t const &s) {
+                           return s.first[0] == s.second[0];
+                       }),
+       "votes restricted to the orientation");
+
+    return test_status();
+}
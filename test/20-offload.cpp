@@ -0,0 +1,114 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/offload.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using seed_t = std::random_device::result_type;
+
+ppht::state<> load_image(seed_t seed) {
+    return load_image(image_01_height, image_01_width, image_01_bits, seed);
+}
+
+/// The order in which the pixels of the image are drawn.
+std::vector<ppht::point_t> draw(seed_t seed) {
+    auto state = load_image(seed);
+    std::vector<ppht::point_t> points;
+    ppht::point_t p;
+
+    while (state.next(p)) points.push_back(p);
+
+    return points;
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{5};
+
+    auto const seed = 696408486U;
+    parameters const param;
+
+    {
+        auto state = load_image(seed);
+        offload_accumulator<> acc{state.rows(), state.cols(), param, seed, 16};
+        scan_buffer buffer;
+        std::vector<segment_t> segments;
+
+        find_segments(state, acc, param, segments, buffer);
+
+        ok(segments == find_segments(load_image(seed), param, seed),
+           "offload accumulator finds the same segments");
+    }
+
+    // Voting in batches finds the lines at the same points as voting
+    // one point at a time.
+
+    auto const points = draw(seed);
+
+    using trigger_t = std::pair<std::size_t, segment_t>;
+
+    std::vector<trigger_t> single, batched;
+
+    stats_observer single_stats, batched_stats;
+    segment_t segment;
+
+    {
+        accumulator<> acc{image_01_height, image_01_width, param, seed};
+
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (acc.vote(points[i], segment, single_stats)) {
+                single.emplace_back(i, segment);
+            }
+        }
+    }
+
+    {
+        offload_accumulator<> acc{image_01_height, image_01_width, param,
+                                  seed};
+
+        auto it = points.begin();
+
+        while (it != points.end()) {
+            auto const end = std::min(it + 64, points.end());
+
+            it = acc.vote(it, end, segment, batched_stats);
+
+            if (it != end) {
+                batched.emplace_back(it - points.begin(), segment);
+                ++it;
+            }
+        }
+    }
+
+    gt(single.size(), 0U, "lines found");
+    ok(batched == single, "batches find the same lines");
+    eq(single_stats.threshold_tests, batched_stats.threshold_tests,
+       "same number of threshold tests");
+
+    // Unvotes are applied in batches; an error is reported when the
+    // batch is applied.
+
+    offload_accumulator<> acc{100, 100, param, seed};
+
+    acc.unvote(point_t{5, 5});
+
+    try {
+        acc.vote(point_t{6, 6}, segment);
+        fail("queued unvote error reported");
+    }
+    catch (std::logic_error const &) {
+        pass("queued unvote error reported");
+    }
+
+    return test_status();
+}
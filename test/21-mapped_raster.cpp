@@ -0,0 +1,91 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/mapped_raster.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+template <template <class> class Raster>
+ppht::state<Raster> load_image(unsigned seed) {
+    return load_image<Raster>(image_01_height, image_01_width, image_01_bits,
+                              seed);
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{8};
+
+    {
+        mapped_raster<std::uint32_t> r{300, 500};
+
+        eq(300U, r.rows(), "rows");
+        eq(500U, r.cols(), "cols");
+
+        bool zero = true;
+
+        for (std::size_t y = 0; y < r.rows(); ++y) {
+            for (std::size_t x = 0; x < r.cols(); ++x) zero &= r[y][x] == 0;
+        }
+
+        ok(zero, "elements start at zero");
+
+        r[299][499] = 42;
+
+        auto moved = std::move(r);
+        eq(42U, moved[299][499], "moved raster keeps its elements");
+    }
+
+    char const *const path = "21-mapped_raster.tmp";
+    std::remove(path);
+
+    {
+        mapped_raster<std::uint16_t> r{10, 20, path};
+        r[3][4] = 1234;
+    }
+
+    {
+        mapped_raster<std::uint16_t> r{10, 20, path};
+        eq(1234U, r[3][4], "file-backed raster persists");
+    }
+
+    std::remove(path);
+
+    try {
+        mapped_raster<std::uint8_t> r{1, 1, "no-such-directory/raster"};
+        fail("open error reported");
+    }
+    catch (std::system_error const &) {
+        pass("open error reported");
+    }
+
+    // The raster serves as the storage of the state and the
+    // accumulator.
+
+    auto const seed = 696408486U;
+    parameters const param;
+
+    auto state = load_image<mapped_raster>(seed);
+    accumulator<std::uint16_t, mapped_raster> acc{state.rows(), state.cols(),
+                                                  param, seed};
+    scan_buffer buffer;
+    std::vector<segment_t> segments;
+
+    find_segments(state, acc, param, segments, buffer);
+
+    gt(segments.size(), 0U, "segments found");
+    ok(segments == find_segments(load_image<raster>(seed), param, seed),
+       "same segments as with raster");
+
+    return test_status();
+}
@@ -0,0 +1,103 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/arena.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+ppht::state<> load_image(unsigned seed) {
+    return load_image(image_01_height, image_01_width, image_01_bits, seed);
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{7};
+
+    {
+        monotonic_arena arena{256};
+
+        auto const a = arena.allocate(1, 1);
+        auto const b = arena.allocate(8, 8);
+
+        eq(0U, reinterpret_cast<std::uintptr_t>(b) % 8, "memory aligned");
+        ne(a, b, "allocations distinct");
+
+        arena.allocate(1000, 8);
+        eq(256U + 1008U, arena.capacity(), "large allocation gets a chunk");
+
+        arena.release();
+
+        ok(arena.allocate(1, 1) == a && arena.capacity() == 256U + 1008U,
+           "memory reused after release");
+    }
+
+    auto const seed = 696408486U;
+    parameters const param;
+
+    auto const expected = find_segments(load_image(seed), param, seed);
+
+    // Once the arena, the accumulator and the scratch storage have
+    // grown to the size of the image, a frame allocates nothing.
+
+    monotonic_arena arena;
+    accumulator<> acc{image_01_height, image_01_width, param, seed};
+    scan_buffer buffer;
+
+    using vector_t = std::vector<segment_t, arena_allocator<segment_t>>;
+
+    bool same = true;
+    std::size_t counted = 0;
+
+    for (int frame = 0; frame < 2; ++frame) {
+        auto state = load_image(seed);
+
+        acc.reset();
+        arena.release();
+
+        auto const before = allocations;
+
+        vector_t segments{arena};
+        find_segments(state, acc, param, segments, buffer);
+
+        counted = allocations - before;
+        same &= std::equal(segments.begin(), segments.end(), expected.begin(),
+                           expected.end());
+    }
+
+    ok(same, "same segments as with the heap");
+    eq(0U, counted, "no heap allocation in a frame");
+    gt(arena.capacity(), 0U, "segments allocated in the arena");
+
+    return test_status();
+}
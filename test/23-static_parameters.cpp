@@ -0,0 +1,113 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/detector.hpp>
+
+#include "image-01.hpp"
+#include "load-image.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+ppht::state<> load_image(unsigned seed) {
+    return load_image(image_01_height, image_01_width, image_01_bits, seed);
+}
+
+/// Exposes the trigonometry table of an accumulator.
+struct probe : ppht::accumulator<> {
+    using ppht::accumulator<>::accumulator;
+    using ppht::accumulator<>::trig;
+};
+
+/// Whether the angular resolution of a parameters class can be set.
+template <class Param, class = void>
+struct settable : std::false_type {};
+
+template <class Param>
+struct settable<Param, decltype(void(std::declval<Param &>().set_max_theta(
+                           std::uint16_t{})))> : std::true_type {};
+
+/// Whether the angular resolution of a parameters class is writable.
+template <class Param, class = void>
+struct writable : std::false_type {};
+
+template <class Param>
+struct writable<Param, decltype(void(std::declval<Param &>().max_theta =
+                                         std::uint16_t{}))> : std::true_type {
+};
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{9};
+
+    using fixed_t = static_parameters<1024, 5>;
+
+    static_assert(fixed_t::max_theta_value == 1024, "max_theta_value");
+    static_assert(settable<parameters>::value, "parameters settable");
+    static_assert(!settable<fixed_t>::value, "max_theta setter absent");
+    static_assert(writable<parameters>::value, "parameters writable");
+    static_assert(!writable<fixed_t>::value, "max_theta not writable");
+    static_assert(
+        std::is_same<decltype(fixed_t{}.set_min_length(1).set_max_gap(2)),
+                     fixed_t &>::value,
+        "chained setters keep the type");
+
+    fixed_t const fixed{parameters{}.set_min_length(7).set_max_theta(64)};
+
+    eq(1024U, fixed.values().max_theta, "max_theta fixed");
+    eq(5U, fixed.values().channel_width, "channel_width fixed");
+    eq(7U, fixed.values().min_length, "other parameters kept");
+
+    {
+        auto const &table = static_trig_table<1024>();
+        trig_table const runtime{1024};
+
+        bool same = true;
+
+        for (std::size_t theta = 0; theta < 1024; ++theta) {
+            same &= table[theta] == runtime[theta];
+        }
+
+        ok(same, "static table has the values of a runtime table");
+    }
+
+    {
+        probe a{100, 100, fixed, 1};
+        probe b{200, 50, fixed, 2};
+        probe c{100, 100, fixed.values(), 3};
+
+        ok(a.trig().cos() == b.trig().cos() &&
+               a.trig().cos() == static_trig_table<1024>().cos(),
+           "accumulators share the static table");
+        ok(c.trig().cos() != a.trig().cos(), "runtime table not shared");
+    }
+
+    auto const seed = 696408486U;
+    static_parameters<2048> const param;
+
+    accumulator<> acc{image_01_height, image_01_width, param, seed};
+    scan_buffer buffer;
+    std::vector<segment_t> segments;
+
+    auto state = load_image(seed);
+    find_segments(state, acc, param, segments, buffer);
+
+    auto const expected = find_segments(load_image(seed), parameters{}, seed);
+
+    ok(segments == expected, "same segments as with runtime parameters");
+    ok(find_segments(load_image(seed), param, seed) == expected,
+       "find_segments accepts static parameters");
+
+    detector<> d{image_01_height, image_01_width, param, seed};
+    auto const image = load_image(seed);
+
+    ok(d.detect(image) == expected, "detector accepts static parameters");
+
+    return test_status();
+}
@@ -0,0 +1,111 @@
+#include <tap.hpp>
+
+TAP_INITIALIZE;
+
+#include <ppht.hpp>
+#include <ppht/batch.hpp>
+
+#include "image-01.hpp"
+#include "image-02.hpp"
+#include "load-image.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using seed_t = std::random_device::result_type;
+
+/// Alternate the two images, each state with its own seed.
+std::vector<ppht::state<>> load_batch(std::size_t count) {
+    std::vector<ppht::state<>> states;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i % 3 == 1) {
+            states.push_back(load_image(image_02_height, image_02_width,
+                                        image_02_bits, i));
+        }
+        else {
+            states.push_back(load_image(image_01_height, image_01_width,
+                                        image_01_bits, i));
+        }
+    }
+
+    return states;
+}
+
+int main() {
+    using namespace tap;
+    using namespace ppht;
+
+    test_plan plan{6};
+
+    auto const seed = 696408486U;
+    parameters const param;
+
+    std::size_t const count = 7;
+
+    std::vector<std::vector<segment_t>> expected;
+
+    {
+        auto states = load_batch(count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            expected.push_back(find_segments<state<> &>(
+                states[i], param, derive_seed(seed, i)));
+        }
+    }
+
+    {
+        auto states = load_batch(count);
+        auto const actual =
+            find_segments_batch(states.begin(), states.end(),
+                                batching{}.set_threads(3), param, seed);
+
+        ok(actual == expected, "results in input order");
+    }
+
+    {
+        auto states = load_batch(count);
+        auto const actual = find_segments_batch(
+            states.begin(), states.end(),
+            batching{}.set_threads(1).set_cache_size(0), param, seed);
+
+        ok(actual == expected, "same results without threads or reuse");
+    }
+
+    {
+        std::vector<state<>> states;
+        auto const actual = find_segments_batch(states.begin(), states.end(),
+                                                batching{}, param, seed);
+
+        ok(actual.empty(), "empty batch");
+    }
+
+    // The cache of a worker.
+
+    batch_worker<accumulator<>> worker{1};
+
+    auto const a = &worker.acquire(100, 200, param, 1);
+    auto const b = &worker.acquire(100, 200, param, 2);
+
+    eq(a, b, "accumulator reused for the same size");
+
+    auto const c = &worker.acquire(200, 100, param, 3);
+
+    ok(c != a, "new accumulator for another size");
+
+    try {
+        // A reused accumulator holds no votes.
+
+        auto &acc = worker.acquire(200, 100, param, 4);
+        segment_t segment;
+
+        acc.vote({5, 5}, segment);
+        worker.acquire(200, 100, param, 5).unvote({5, 5});
+        fail("reused accumulator reset");
+    }
+    catch (std::logic_error const &) {
+        pass("reused accumulator reset");
+    }
+
+    return test_status();
+}
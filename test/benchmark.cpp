@@ -0,0 +1,442 @@
+/*
+ * Performance benchmarks for the components of the PPHT algorithm.
+ *
+ * Built by "make bench", not by "make check".  Each result is written
+ * to standard output as one JSON object per line:
+ *
+ *   {"name": "vote", "size": "1024x1024", "density": 0.01,
+ *    "ops": 123456, "ns_per_op": 812.3, "allocs_per_op": 0,
+ *    "pixels_per_s": 1.23e+06}
+ *
+ * "pixels_per_s" is only meaningful for the benchmarks that process a
+ * whole image and is zero elsewhere.  Arguments, if any, select the
+ * benchmarks whose names contain one of them.
+ */
+
+#include <ppht.hpp>
+#include <ppht/coarse_accumulator.hpp>
+#include <ppht/kd-search.hpp>
+#include <ppht/pipeline.hpp>
+
+#include "image-01.hpp"
+#include "image-02.hpp"
+#include "load-image.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/// The minimum time spent in each benchmark.
+constexpr std::chrono::milliseconds min_time{200};
+
+/// The seed of every random sequence, so runs are comparable.
+constexpr unsigned seed = 696408486U;
+
+std::vector<std::string> filters;
+
+/// A set of pixels and the dimensions of its image.
+struct image_t {
+    std::string name;
+    std::size_t rows, cols;
+    double density;
+    std::vector<ppht::point_t> pixels;
+};
+
+/**
+ * A synthetic image: a grid of horizontal, vertical and diagonal
+ * lines, plus uniform noise covering a fraction @c noise of the
+ * pixels.  The density reported is that of the whole image.
+ */
+image_t synthetic(std::size_t size, double noise) {
+    image_t image{std::to_string(size) + "x" + std::to_string(size), size,
+                  size, 0, {}};
+
+    std::vector<bool> set(size * size);
+
+    auto const mark = [&](long x, long y) {
+        if (x < 0 || y < 0 || x >= long(size) || y >= long(size)) return;
+        if (set[y * size + x]) return;
+        set[y * size + x] = true;
+        image.pixels.emplace_back(x, y);
+    };
+
+    long const step = size / 8;
+
+    for (long k = step / 2; k < long(size); k += step) {
+        for (long i = step / 4; i < long(size) - step / 4; ++i) {
+            mark(i, k);
+            mark(k, i);
+        }
+    }
+
+    for (long i = 0; i < long(size); ++i) mark(i, i);
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> coord{0, long(size) - 1};
+
+    auto const target = image.pixels.size() +
+                        static_cast<std::size_t>(noise * size * size);
+
+    while (image.pixels.size() < target) mark(coord(urbg), coord(urbg));
+
+    image.density = double(image.pixels.size()) / (size * size);
+
+    return image;
+}
+
+/// One of the test fixtures.
+image_t fixture(char const *name, std::size_t rows, std::size_t cols,
+                std::uint8_t const *bits) {
+    image_t image{name, rows, cols, 0, {}};
+
+    for (std::size_t y = 0; y < rows; ++y) {
+        for (std::size_t x = 0; x < cols; ++x) {
+            if (is_set(bits, cols, x, y)) image.pixels.emplace_back(x, y);
+        }
+    }
+
+    image.density = double(image.pixels.size()) / (rows * cols);
+
+    return image;
+}
+
+ppht::state<> load(image_t const &image) {
+    ppht::state<> state{image.rows, image.cols, seed};
+    for (auto &&p : image.pixels) state.mark_pending(p);
+    return state;
+}
+
+bool selected(char const *name) {
+    if (filters.empty()) return true;
+
+    for (auto &&f : filters) {
+        if (std::strstr(name, f.c_str())) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Run a benchmark and print its result.
+ *
+ * @param setup a function preparing the input of a batch; its time
+ *   and allocations are not counted
+ *
+ * @param op a function taking the result of @c setup, performing a
+ *   batch of operations and returning the number of operations
+ *   performed; batches are run until at least @ref min_time has
+ *   elapsed
+ *
+ * @param pixels the number of pixels processed per operation, or zero
+ */
+template <class Setup, class Op>
+void run(char const *name, image_t const &image, std::size_t pixels,
+         Setup &&setup, Op &&op) {
+    if (!selected(name)) return;
+
+    std::size_t ops = 0;
+    std::size_t allocs = 0;
+    clock_type::duration elapsed{0};
+
+    while (elapsed < min_time) {
+        auto input = setup();
+
+        auto const a0 = allocations.load();
+        auto const t0 = clock_type::now();
+
+        ops += op(input);
+
+        elapsed += clock_type::now() - t0;
+        allocs += allocations.load() - a0;
+    }
+
+    double const ns =
+        std::chrono::duration<double, std::nano>(elapsed).count();
+    double const ns_per_op = ops ? ns / ops : 0;
+
+    std::printf("{\"name\": \"%s\", \"size\": \"%s\", \"density\": %.4f, "
+                "\"ops\": %zu, \"ns_per_op\": %.1f, "
+                "\"allocs_per_op\": %.2f, \"pixels_per_s\": %.4g}\n",
+                name, image.name.c_str(), image.density, ops, ns_per_op,
+                ops ? double(allocs) / ops : 0.0,
+                pixels && ns_per_op ? pixels * 1e9 / ns_per_op : 0.0);
+    std::fflush(stdout);
+}
+
+/// Run a benchmark that needs no setup.
+template <class Op>
+void run(char const *name, image_t const &image, std::size_t pixels,
+         Op &&op) {
+    run(name, image, pixels, [] { return 0; }, [&](int) { return op(); });
+}
+
+void bench_image(image_t const &image) {
+    ppht::parameters const param;
+
+    // Vote every pixel into a cleared accumulator; the votes that
+    // trigger a scan are included in the cost.  Then unvote them.
+
+    {
+        ppht::accumulator<> acc{image.rows, image.cols, param, seed};
+        ppht::segment_t segment;
+
+        run("vote", image, 0,
+            [&] {
+                acc.reset();
+                return 0;
+            },
+            [&](int) {
+                for (auto &&p : image.pixels) acc.vote(p, segment);
+                return image.pixels.size();
+            });
+
+        // The same with each vote restricted to a window of about a
+        // thirtieth of the angles.
+
+        run("vote_oriented", image, 0,
+            [&] {
+                acc.reset();
+                return 0;
+            },
+            [&](int) {
+                for (auto &&p : image.pixels) acc.vote(p, 0.0, 0.05, segment);
+                return image.pixels.size();
+            });
+
+        run("unvote", image, 0,
+            [&] {
+                acc.reset();
+                for (auto &&p : image.pixels) acc.vote(p, segment);
+                return 0;
+            },
+            [&](int) {
+                for (auto &&p : image.pixels) acc.unvote(p);
+                return image.pixels.size();
+            });
+    }
+
+    // Scan a channel across the full width of the image through each
+    // of the (at most eight) rows at least an eighth full.
+
+    {
+        auto state = load(image);
+        ppht::scan_buffer buffer;
+
+        std::vector<std::pair<long, long>> rows(image.rows);
+
+        for (std::size_t y = 0; y < image.rows; ++y) rows[y].second = y;
+        for (auto &&p : image.pixels) --rows[p[1]].first;
+
+        std::sort(rows.begin(), rows.end());
+
+        auto const full = [&](std::pair<long, long> const &row) {
+            return -row.first >= long(image.cols / 8);
+        };
+
+        rows.erase(std::find_if_not(rows.begin(), rows.end(), full),
+                   rows.end());
+        rows.resize(std::min<std::size_t>(8, rows.size()));
+
+        run("scan", image, 0, [&] {
+            for (auto &&row : rows) {
+                auto const y = row.second;
+                ppht::segment_t channel{{0, y}, {long(image.cols) - 1, y}};
+                ppht::scan(state, channel, param.channel_width >> 1,
+                           param.max_gap, buffer);
+            }
+
+            return rows.size();
+        });
+    }
+
+    // Drain the pending queue; loading the state is not timed.
+
+    run("next", image, 0, [&] { return load(image); },
+        [&](ppht::state<> &state) {
+            ppht::point_t p;
+            std::size_t n = 0;
+
+            while (state.next(p)) ++n;
+
+            return n;
+        });
+
+    run("find_segments", image, image.pixels.size(),
+        [&] { return load(image); },
+        [&](ppht::state<> &state) {
+            ppht::find_segments(state, param, seed);
+            return std::size_t{1};
+        });
+
+    {
+        ppht::scan_pipeline pipeline;
+        ppht::accumulator<> acc{image.rows, image.cols, param, seed};
+        ppht::scan_buffer buffer;
+        std::vector<ppht::segment_t> segments;
+
+        run("find_segments_pipelined", image, image.pixels.size(),
+            [&] {
+                acc.reset();
+                segments.clear();
+                return load(image);
+            },
+            [&](ppht::state<> &state) {
+                pipeline.find_segments(state, acc, param, segments, buffer);
+                return std::size_t{1};
+            });
+    }
+
+    {
+        ppht::coarse_accumulator<> acc{image.rows, image.cols, param, seed};
+        ppht::scan_buffer buffer;
+        std::vector<ppht::segment_t> segments;
+
+        run("find_segments_coarse", image, image.pixels.size(),
+            [&] {
+                acc.reset();
+                segments.clear();
+                return load(image);
+            },
+            [&](ppht::state<> &state) {
+                ppht::find_segments(state, acc, param, segments, buffer);
+                return std::size_t{1};
+            });
+    }
+
+    // Construct an accumulator for the image, building its
+    // trigonometry table or sharing the static one.
+
+    run("accumulator", image, 0, [&] {
+        ppht::accumulator<> acc{image.rows, image.cols, param, seed};
+        return std::size_t{1};
+    });
+
+    run("accumulator_static", image, 0, [&] {
+        ppht::static_parameters<2048> const fixed{param};
+        ppht::accumulator<> acc{image.rows, image.cols, fixed, seed};
+        return std::size_t{1};
+    });
+}
+
+void bench_search() {
+    image_t const image = synthetic(1024, 0.01);
+
+    using entry_t = std::tuple<ppht::point_t, std::size_t>;
+
+    std::vector<entry_t> entries;
+
+    for (std::size_t i = 0; i < image.pixels.size(); ++i) {
+        entries.emplace_back(image.pixels[i], i);
+    }
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> coord{0, 1023};
+    std::vector<entry_t> found;
+
+    run("kd_search", image, 0, [&] {
+        for (int i = 0; i < 100; ++i) {
+            found.clear();
+            ppht::kd_search(entries.begin(), entries.end(),
+                            std::back_inserter(found),
+                            ppht::point_t{coord(urbg), coord(urbg)}, 3);
+        }
+        return std::size_t{100};
+    });
+
+    ppht::kd_tree<entry_t> tree{entries.begin(), entries.end()};
+    std::vector<std::size_t> indices;
+
+    run("kd_tree", image, 0, [&] {
+        for (int i = 0; i < 1000; ++i) {
+            indices.clear();
+            tree.search(std::back_inserter(indices),
+                        ppht::point_t{coord(urbg), coord(urbg)}, 3);
+        }
+        return std::size_t{1000};
+    });
+}
+
+void bench_postprocess(std::size_t count) {
+    image_t image{std::to_string(count) + " segments", 2048, 2048, 0, {}};
+
+    // Chains of short colinear pieces with gaps smaller than the
+    // merge limit, shuffled.
+
+    std::default_random_engine urbg{seed};
+    std::uniform_int_distribution<long> coord{0, 2000};
+    std::vector<ppht::segment_t> segments;
+
+    while (segments.size() < count) {
+        long const x = coord(urbg), y = coord(urbg);
+
+        for (long i = 0; i < 5; ++i) {
+            segments.emplace_back(ppht::point_t{x + 20 * i, y},
+                                  ppht::point_t{x + 20 * i + 18, y});
+        }
+    }
+
+    std::shuffle(segments.begin(), segments.end(), urbg);
+
+    run("postprocess", image, 0, [&] { return segments; },
+        [&](std::vector<ppht::segment_t> &copy) {
+            ppht::postprocess(copy.begin(), copy.end(), 1);
+            return std::size_t{1};
+        });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) filters.emplace_back(argv[i]);
+
+    bench_image(fixture("image-01", image_01_height, image_01_width,
+                        image_01_bits));
+    bench_image(fixture("image-02", image_02_height, image_02_width,
+                        image_02_bits));
+
+    for (std::size_t size : {256, 1024, 2048}) {
+        for (double noise : {0.01, 0.05}) {
+            bench_image(synthetic(size, noise));
+        }
+    }
+
+    bench_search();
+
+    for (std::size_t count : {1000, 5000}) bench_postprocess(count);
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef _load_image_hpp_
+#define _load_image_hpp_
+
+#include <ppht/state.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+/// Test whether a pixel of one of the bitmaps is set.
+inline bool is_set(std::uint8_t const *bits, std::size_t cols,
+                   std::size_t x, std::size_t y) {
+    std::size_t bytes_per_row = (cols + 7) >> 3;
+    return bits[y * bytes_per_row + (x >> 3)] & (1U << (x & 7));
+}
+
+/// Mark the set pixels of a bitmap of the size of a state pending.
+template <class State>
+void mark_image(State &state, std::uint8_t const *bits) {
+    for (unsigned y = 0; y < state.rows(); ++y) {
+        for (unsigned x = 0; x < state.cols(); ++x) {
+            if (is_set(bits, state.cols(), x, y)) state.mark_pending({x, y});
+        }
+    }
+}
+
+/// Load a bitmap into a new state.
+template <template <class> class Raster = ppht::raster>
+ppht::state<Raster> load_image(std::size_t rows, std::size_t cols,
+                               std::uint8_t const *bits,
+                               std::random_device::result_type seed =
+                                   std::random_device{}()) {
+    ppht::state<Raster> state{rows, cols, seed};
+    mark_image(state, bits);
+    return state;
+}
+
+#endif